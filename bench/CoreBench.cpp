@@ -0,0 +1,351 @@
+/*
+
+CHP-8 Core Benchmark Suite
+
+Times the core on a fixed set of workloads, each repeated so results come with a spread rather than a single
+number:
+
+	alu       register arithmetic, families 6, 7 and 8
+	branch    skips and jumps, families 3, 4, 5, 9 and 1NNN
+	call      nested 2NNN / 00EE
+	dxyn      sprites of 8 and 15 rows at moving positions
+	convert   128x64 frames converted to RGBA through MonoVideo's FrameConverter
+	upload    conversion plus a texture upload, only when built with CHP8_BENCH_SFML (needs SFML and a GL context)
+
+The CPU workloads run on the interpreter, threaded and recompiled engines. Every case reports the median, mean,
+standard deviation and minimum time per operation over the repetitions, operations per second from the median, and
+host instructions per operation where perf events are available ("n/a" otherwise, null in JSON). With --json the
+results are also written as a JSON document for tracking across commits.
+
+Usage: CoreBench [--repeat n] [--instructions n] [--frames n] [--filter name] [--json file]
+
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(CHP8_BENCH_SFML)
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Window/Context.hpp>
+#endif
+
+#include "../src/core/CHP-8.hpp"
+#include "../src/frontend/FrameConverter.hpp"
+#include "HostInstructionCounter.hpp"
+
+using namespace chp8;
+
+/****************************************************************
+			Workloads
+****************************************************************/
+
+// Endless loops, each spending nearly all of its time in the instructions it is named for
+static const uint8_t aluProgram[] = {
+	0x60, 0x01, // 200: V0 = 1
+	0x61, 0x03, // 202: V1 = 3
+	0x62, 0x07, // 204: V2 = 7
+	0x80, 0x14, // 206: V0 += V1
+	0x81, 0x05, // 208: V1 -= V0
+	0x82, 0x01, // 20A: V2 |= V0
+	0x83, 0x22, // 20C: V3 &= V2
+	0x84, 0x33, // 20E: V4 ^= V3
+	0x85, 0x56, // 210: V5 >>= 1, Vy is V5 so every profile shifts in place
+	0x86, 0x6E, // 212: V6 <<= 1
+	0x87, 0x17, // 214: V7 = V1 - V7
+	0x88, 0x00, // 216: V8 = V0
+	0x79, 0x05, // 218: V9 += 5
+	0x6A, 0x2C, // 21A: VA = 0x2C
+	0x8A, 0x94, // 21C: VA += V9
+	0x12, 0x06  // 21E: jump 206
+};
+
+static const uint8_t branchProgram[] = {
+	0x63, 0x01, // 200: V3 = 1
+	0x70, 0x01, // 202: V0 += 1
+	0x81, 0x00, // 204: V1 = V0
+	0x81, 0x32, // 206: V1 &= V3, alternates 0 and 1
+	0x31, 0x00, // 208: skip if V1 == 0
+	0x12, 0x10, // 20A: jump 210
+	0x41, 0x01, // 20C: skip if V1 != 1
+	0x12, 0x02, // 20E: jump 202 (never taken)
+	0x51, 0x30, // 210: skip if V1 == V3
+	0x12, 0x14, // 212: jump 214
+	0x91, 0x30, // 214: skip if V1 != V3
+	0x12, 0x02, // 216: jump 202
+	0x12, 0x02  // 218: jump 202
+};
+
+static const uint8_t callProgram[] = {
+	0x22, 0x06, // 200: call 206
+	0x12, 0x00, // 202: jump 200
+	0x00, 0x00, // 204:
+	0x22, 0x0C, // 206: call 20C
+	0x00, 0xEE, // 208: return
+	0x00, 0x00, // 20A:
+	0x70, 0x01, // 20C: V0 += 1
+	0x00, 0xEE  // 20E: return
+};
+
+static const uint8_t dxynProgram[] = {
+	0xA2, 0x20, // 200: I = 220
+	0x60, 0x00, // 202: V0 = 0
+	0x61, 0x00, // 204: V1 = 0
+	0xD0, 0x18, // 206: draw 8 rows at V0, V1
+	0x70, 0x05, // 208: V0 += 5
+	0x71, 0x03, // 20A: V1 += 3
+	0xD0, 0x1F, // 20C: draw 15 rows at V0, V1
+	0x70, 0x0B, // 20E: V0 += 11
+	0x12, 0x06, // 210: jump 206
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 212: padding
+	0xF0, 0x90, 0x90, 0x90, 0xF0, 0x3C, 0x7E, 0xFF, // 220: sprite
+	0xFF, 0x7E, 0x3C, 0x18, 0x81, 0x42, 0x24
+};
+
+struct Workload {
+	const char* name;
+	const uint8_t* program;
+	size_t size;
+};
+
+static const Workload workloads[] = {
+	{ "alu", aluProgram, sizeof(aluProgram) },
+	{ "branch", branchProgram, sizeof(branchProgram) },
+	{ "call", callProgram, sizeof(callProgram) },
+	{ "dxyn", dxynProgram, sizeof(dxynProgram) }
+};
+
+struct EngineName {
+	Chip8::Engine engine;
+	const char* name;
+};
+
+static const EngineName engines[] = {
+	{ Chip8::Interpreter, "interpreter" },
+	{ Chip8::Threaded, "threaded" },
+	{ Chip8::Recompiled, "recompiled" }
+};
+
+/****************************************************************
+			Measurement
+****************************************************************/
+
+struct Result {
+	std::string name;
+	std::string engine; // Empty where it doesn't apply
+	std::string unit;
+	uint64_t operations; // Per repetition
+	double median;
+	double mean;
+	double stddev;
+	double min;
+	bool hasHostInstructions;
+	double hostInstructions; // Per operation, median over repetitions
+};
+
+static double median(std::vector<double> samples) {
+	std::sort(samples.begin(), samples.end());
+	size_t middle = samples.size() / 2;
+	return samples.size() % 2 ? samples[middle] : (samples[middle - 1] + samples[middle]) / 2;
+}
+
+/*
+Runs body (which performs operations operations) repeat times, and summarises ns and host instructions per
+operation
+*/
+template <typename Body> static Result measure(const std::string& name, const std::string& engine, const std::string& unit, uint64_t operations, int repeat, Body body) {
+	HostInstructionCounter counter;
+	std::vector<double> ns, host;
+	for (int r = 0; r < repeat; r++) {
+		auto begin = std::chrono::steady_clock::now();
+		counter.start();
+		body();
+		uint64_t hostInstructions = counter.stop();
+		auto end = std::chrono::steady_clock::now();
+		ns.push_back(std::chrono::duration<double, std::nano>(end - begin).count() / operations);
+		host.push_back((double)hostInstructions / operations);
+	}
+
+	Result result;
+	result.name = name;
+	result.engine = engine;
+	result.unit = unit;
+	result.operations = operations;
+	result.median = median(ns);
+	result.min = *std::min_element(ns.begin(), ns.end());
+	double sum = 0;
+	for (double s : ns)
+		sum += s;
+	result.mean = sum / ns.size();
+	double squares = 0;
+	for (double s : ns)
+		squares += (s - result.mean) * (s - result.mean);
+	result.stddev = ns.size() > 1 ? std::sqrt(squares / (ns.size() - 1)) : 0.0;
+	result.hasHostInstructions = counter.isAvailable();
+	result.hostInstructions = counter.isAvailable() ? median(host) : 0.0;
+	return result;
+}
+
+static Result runWorkload(const Workload& workload, const EngineName& engine, int instructions, int repeat) {
+	Chip8 chip("chip8", "");
+	chip.setEngine(engine.engine);
+	chip.loadProgram(workload.program, workload.size);
+	chip.execute(10000); // Warm the decode cache and compile the blocks
+
+	return measure(workload.name, engine.name, "instruction", (uint64_t)instructions, repeat, [&]() {
+		chip.execute(instructions);
+	});
+}
+
+static void fillFramebuffer(Framebuffer& framebuffer) {
+	std::mt19937_64 rng(8);
+	for (unsigned int y = 0; y < framebuffer.getMode().height; y++) {
+		for (unsigned int x = 0; x < framebuffer.getMode().width; x += 64)
+			framebuffer.xorRow(x, y, rng());
+	}
+}
+
+static Result runConvert(int frames, int repeat) {
+	Framebuffer framebuffer(Framebuffer::_128x64);
+	fillFramebuffer(framebuffer);
+	FrameConverter converter(0xFFFFFFFF, 0xFF000000);
+	converter.setVideoMode(framebuffer.getMode());
+	unsigned int height = (unsigned int)framebuffer.getMode().height;
+
+	volatile uint32_t sink = 0;
+	return measure("convert", "", "frame", (uint64_t)frames, repeat, [&]() {
+		for (int f = 0; f < frames; f++) {
+			for (unsigned int y = 0; y < height; y++)
+				converter.convertRow(framebuffer, y);
+			sink = converter.getRow(f % height)[0];
+		}
+	});
+}
+
+#if defined(CHP8_BENCH_SFML)
+static Result runUpload(int frames, int repeat) {
+	// An offscreen context is enough for textures, no window needed. Uploads are queued by the driver, so this
+	// measures what the emulation thread pays for them
+	sf::Context context;
+	Framebuffer framebuffer(Framebuffer::_128x64);
+	fillFramebuffer(framebuffer);
+	FrameConverter converter(0xFFFFFFFF, 0xFF000000);
+	converter.setVideoMode(framebuffer.getMode());
+	unsigned int width = (unsigned int)framebuffer.getMode().width;
+	unsigned int height = (unsigned int)framebuffer.getMode().height;
+	sf::Texture texture;
+	texture.create(width, height);
+
+	return measure("upload", "", "frame", (uint64_t)frames, repeat, [&]() {
+		for (int f = 0; f < frames; f++) {
+			for (unsigned int y = 0; y < height; y++)
+				converter.convertRow(framebuffer, y);
+			texture.update((const sf::Uint8*)converter.getRow(0), width, height, 0, 0);
+		}
+	});
+}
+#endif
+
+/****************************************************************
+			Output
+****************************************************************/
+
+static void printResult(const Result& result) {
+	char line[200];
+	char host[32] = "n/a";
+	if (result.hasHostInstructions)
+		std::snprintf(host, sizeof(host), "%.2f", result.hostInstructions);
+	std::string name = result.engine.empty() ? result.name : result.name + "/" + result.engine;
+	std::snprintf(line, sizeof(line), "%-20s %10.2f %10.2f %8.2f %10.2f  ns/%-11s %10.2fM/s  %8s host/op",
+		name.c_str(), result.median, result.mean, result.stddev, result.min, result.unit.c_str(), 1e3 / result.median, host);
+	std::cout << line << std::endl;
+}
+
+static bool writeJson(const std::string& path, const std::vector<Result>& results, int repeat) {
+	std::ofstream out(path);
+	if (!out)
+		return false;
+
+	char number[64];
+	auto format = [&number](double value) {
+		std::snprintf(number, sizeof(number), "%.4f", value);
+		return std::string(number);
+	};
+
+	out << "{\n  \"suite\": \"CoreBench\",\n  \"repeat\": " << repeat << ",\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result& r = results[i];
+		out << "    {\"name\": \"" << r.name << "\", \"engine\": " << (r.engine.empty() ? "null" : "\"" + r.engine + "\"")
+			<< ", \"unit\": \"" << r.unit << "\", \"operations\": " << r.operations
+			<< ", \"ns_per_op\": {\"median\": " << format(r.median) << ", \"mean\": " << format(r.mean)
+			<< ", \"stddev\": " << format(r.stddev) << ", \"min\": " << format(r.min) << "}"
+			<< ", \"ops_per_second\": " << format(1e9 / r.median)
+			<< ", \"host_instructions_per_op\": " << (r.hasHostInstructions ? format(r.hostInstructions) : "null") << "}"
+			<< (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	out << "  ]\n}\n";
+	return (bool)out;
+}
+
+int main(int argc, char* argv[]) {
+	int repeat = 15;
+	int instructions = 2000000;
+	int frames = 2000;
+	std::string filter;
+	std::string jsonPath;
+	for (int a = 1; a < argc; a++) {
+		std::string arg = argv[a];
+		if (arg == "--repeat" && a + 1 < argc)
+			repeat = std::max(1, std::atoi(argv[++a]));
+		else if (arg == "--instructions" && a + 1 < argc)
+			instructions = std::max(1, std::atoi(argv[++a]));
+		else if (arg == "--frames" && a + 1 < argc)
+			frames = std::max(1, std::atoi(argv[++a]));
+		else if (arg == "--filter" && a + 1 < argc)
+			filter = argv[++a];
+		else if (arg == "--json" && a + 1 < argc)
+			jsonPath = argv[++a];
+		else {
+			std::cout << "Usage: " << argv[0] << " [--repeat n] [--instructions n] [--frames n] [--filter name] [--json file]" << std::endl;
+			return 1;
+		}
+	}
+	auto selected = [&filter](const std::string& name) { return filter.empty() || name.find(filter) != std::string::npos; };
+
+	std::cout << "Repetitions: " << repeat << std::endl;
+	std::cout << "case                     median       mean   stddev        min" << std::endl;
+
+	std::vector<Result> results;
+	for (const Workload& workload : workloads) {
+		for (const EngineName& engine : engines) {
+			if (!selected(std::string(workload.name) + "/" + engine.name))
+				continue;
+			results.push_back(runWorkload(workload, engine, instructions, repeat));
+			printResult(results.back());
+		}
+	}
+	if (selected("convert")) {
+		results.push_back(runConvert(frames, repeat));
+		printResult(results.back());
+	}
+#if defined(CHP8_BENCH_SFML)
+	if (selected("upload")) {
+		results.push_back(runUpload(frames, repeat));
+		printResult(results.back());
+	}
+#endif
+
+	if (!jsonPath.empty() && !writeJson(jsonPath, results, repeat)) {
+		std::cout << "Failed to write " << jsonPath << std::endl;
+		return 1;
+	}
+	return 0;
+}
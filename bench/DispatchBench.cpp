@@ -0,0 +1,112 @@
+/*
+
+CHP-8 Dispatch Benchmark
+
+Runs the same synthetic program on the interpreter and threaded engines, checks they end in the same state, and
+reports how many host instructions each spends per emulated instruction. Host instructions are read from the
+hardware counters on Linux, elsewhere only the time per instruction is reported.
+
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include "../src/core/CHP-8.hpp"
+#include "HostInstructionCounter.hpp"
+
+/****************************************************************
+			Benchmark
+****************************************************************/
+
+// An endless mix of ALU, skip, jump and call/return instructions
+static const uint8_t program[] = {
+	0x60, 0x00, // 200: V0 = 0
+	0x61, 0x01, // 202: V1 = 1
+	0x62, 0x10, // 204: V2 = 0x10
+	0x80, 0x14, // 206: V0 += V1
+	0x83, 0x00, // 208: V3 = V0
+	0x83, 0x25, // 20A: V3 -= V2
+	0x83, 0x06, // 20C: V3 >>= 1
+	0x84, 0x32, // 20E: V4 = V4 & V3
+	0x84, 0x0E, // 210: V4 <<= 1
+	0x71, 0x03, // 212: V1 += 3
+	0x30, 0x00, // 214: skip if V0 == 0
+	0x22, 0x1A, // 216: call 21A
+	0x12, 0x06, // 218: jump 206
+	0x85, 0x13, // 21A: V5 ^= V1
+	0x95, 0x00, // 21C: skip if V5 != V0
+	0x75, 0x01, // 21E: V5 += 1
+	0x00, 0xEE  // 220: return
+};
+
+struct EngineResult {
+	double nsPerInstruction;
+	double hostInstructionsPerInstruction;
+	bool hasHostInstructions; // False without perf events
+};
+
+static EngineResult runEngine(chp8::Chip8& chip, chp8::Chip8::Engine engine, int instructions) {
+	HostInstructionCounter counter;
+
+	chip.setEngine(engine);
+	chip.loadProgram(program, sizeof(program));
+	chip.execute(1000); // Warm the decode cache
+
+	auto begin = std::chrono::steady_clock::now();
+	counter.start();
+	chip.execute(instructions);
+	uint64_t hostInstructions = counter.stop();
+	auto end = std::chrono::steady_clock::now();
+
+	EngineResult result;
+	result.nsPerInstruction = std::chrono::duration<double, std::nano>(end - begin).count() / instructions;
+	result.hasHostInstructions = counter.isAvailable();
+	result.hostInstructionsPerInstruction = result.hasHostInstructions ? (double)hostInstructions / instructions : 0.0;
+	return result;
+}
+
+static std::string hostInstructions(const EngineResult& result) {
+	if (!result.hasHostInstructions)
+		return "n/a";
+	std::ostringstream text;
+	text << std::fixed << std::setprecision(2) << result.hostInstructionsPerInstruction;
+	return text.str();
+}
+
+static bool sameState(chp8::Chip8& a, chp8::Chip8& b) {
+	for (uint8_t i = 0; i < 0x10; i++) {
+		if (a.getRegister(i) != b.getRegister(i))
+			return false;
+	}
+	return a.getI() == b.getI() && a.getPC() == b.getPC() && a.getSP() == b.getSP();
+}
+
+int main(int argc, char* argv[]) {
+	int instructions = 50000000;
+	if (argc > 1)
+		instructions = std::atoi(argv[1]);
+
+	chp8::Chip8 interpreterChip("chip8", "Nothing2");
+	chp8::Chip8 threadedChip("chip8", "Nothing2");
+
+	EngineResult interpreter = runEngine(interpreterChip, chp8::Chip8::Interpreter, instructions);
+	EngineResult threaded = runEngine(threadedChip, chp8::Chip8::Threaded, instructions);
+
+	if (!sameState(interpreterChip, threadedChip)) {
+		std::cout << "Engines diverged after " << instructions << " instructions" << std::endl;
+		return 1;
+	}
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "Instructions per engine: " << instructions << std::endl;
+	std::cout << "Interpreter: " << interpreter.nsPerInstruction << " ns/instruction, "
+		<< hostInstructions(interpreter) << " host instructions/instruction" << std::endl;
+	std::cout << "Threaded:    " << threaded.nsPerInstruction << " ns/instruction, "
+		<< hostInstructions(threaded) << " host instructions/instruction" << std::endl;
+	return 0;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/****************************************************************
+			Host Instruction Counter
+****************************************************************/
+
+/*
+Counts the instructions this thread retires in user space, through perf events on Linux. Elsewhere, or where perf
+events are restricted, isAvailable() is false and stop() returns 0
+*/
+class HostInstructionCounter {
+public:
+	HostInstructionCounter() {
+#if defined(__linux__)
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.size = sizeof(attr);
+		attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+	}
+
+	~HostInstructionCounter() {
+#if defined(__linux__)
+		if (fd >= 0)
+			close(fd);
+#endif
+	}
+
+	bool isAvailable() {
+		return fd >= 0;
+	}
+
+	void start() {
+#if defined(__linux__)
+		if (fd >= 0) {
+			ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+#endif
+	}
+
+	uint64_t stop() {
+		uint64_t count = 0;
+#if defined(__linux__)
+		if (fd >= 0) {
+			ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+			if (read(fd, &count, sizeof(count)) != sizeof(count))
+				count = 0;
+		}
+#endif
+		return count;
+	}
+
+private:
+	int fd = -1;
+
+};
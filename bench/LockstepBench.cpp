@@ -0,0 +1,111 @@
+/*
+
+CHP-8 Lockstep Benchmark
+
+Runs one program on N instances, first one after another on the scalar threaded engine, then together on the
+lockstep engine, checks every lane ends in the same state as its scalar run, and compares aggregate throughput.
+Each instance holds a different key, so a skip on the keypad splits the lanes every time round the loop.
+
+Usage: LockstepBench [lanes] [instructions per lane]
+
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+#include "../src/core/CHP-8.hpp"
+#include "../src/core/Lockstep.hpp"
+
+// An endless register loop with a call and a key dependent skip
+static const uint8_t program[] = {
+	0x60, 0x00, // 200: V0 = 0
+	0x61, 0x01, // 202: V1 = 1
+	0x80, 0x14, // 204: V0 += V1
+	0x71, 0x05, // 206: V1 += 5
+	0x82, 0x06, // 208: V2 >>= 1
+	0x83, 0x04, // 20A: V3 += V0
+	0x84, 0x15, // 20C: V4 -= V1
+	0x85, 0x23, // 20E: V5 ^= V2
+	0x33, 0x00, // 210: skip if V3 == 0
+	0x22, 0x22, // 212: call 222
+	0x76, 0x01, // 214: V6 += 1
+	0xE6, 0x9E, // 216: skip if key V6 is held
+	0x77, 0x01, // 218: V7 += 1
+	0x88, 0x74, // 21A: V8 += V7
+	0x98, 0x30, // 21C: skip if V8 != V3
+	0x79, 0x01, // 21E: V9 += 1
+	0x12, 0x04, // 220: jump 204
+	0x8A, 0x0E, // 222: VA <<= 1
+	0x7A, 0x01, // 224: VA += 1
+	0x00, 0xEE  // 226: return
+};
+
+static uint16_t laneKeys(size_t lane) {
+	return (uint16_t)(1 << (lane % 16));
+}
+
+int main(int argc, char* argv[]) {
+	size_t lanes = argc > 1 ? (size_t)std::atoi(argv[1]) : 1024;
+	uint32_t instructions = argc > 2 ? (uint32_t)std::atoi(argv[2]) : 100000;
+
+	// Scalar: one instance reused for every lane
+	chp8::Chip8 chip("chip8", "Nothing2");
+	chip.setEngine(chp8::Chip8::Threaded);
+	chp8::Lockstep lockstep(lanes);
+
+	struct LaneState {
+		uint8_t v[0x10];
+		uint16_t i, pc;
+		uint8_t sp;
+	};
+	LaneState* expected = new LaneState[lanes];
+
+	auto scalarBegin = std::chrono::steady_clock::now();
+	for (size_t l = 0; l < lanes; l++) {
+		chip.reset();
+		chip.loadProgram(program, sizeof(program));
+		chip.setKeys(laneKeys(l));
+		chip.execute(instructions);
+
+		for (uint8_t x = 0; x < 0x10; x++)
+			expected[l].v[x] = chip.getRegister(x);
+		expected[l].i = chip.getI();
+		expected[l].pc = chip.getPC();
+		expected[l].sp = chip.getSP();
+	}
+	auto scalarEnd = std::chrono::steady_clock::now();
+
+	lockstep.loadProgram(program, sizeof(program));
+	for (size_t l = 0; l < lanes; l++)
+		lockstep.setKeys(l, laneKeys(l));
+
+	auto lockstepBegin = std::chrono::steady_clock::now();
+	uint64_t laneInstructions = lockstep.execute(instructions);
+	auto lockstepEnd = std::chrono::steady_clock::now();
+
+	for (size_t l = 0; l < lanes; l++) {
+		bool same = lockstep.getI(l) == expected[l].i && lockstep.getPC(l) == expected[l].pc && lockstep.getSP(l) == expected[l].sp;
+		for (uint8_t x = 0; x < 0x10; x++)
+			same = same && lockstep.getRegister(l, x) == expected[l].v[x];
+		if (!same) {
+			std::cout << "Lane " << l << " diverged from its scalar run" << std::endl;
+			return 1;
+		}
+	}
+	delete[] expected;
+
+	double total = (double)lanes * instructions;
+	double scalarNs = std::chrono::duration<double, std::nano>(scalarEnd - scalarBegin).count();
+	double lockstepNs = std::chrono::duration<double, std::nano>(lockstepEnd - lockstepBegin).count();
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "Lanes: " << lanes << ", instructions per lane: " << instructions << std::endl;
+	std::cout << "Scalar:   " << scalarNs / total << " ns/instruction, " << total / scalarNs * 1e3 << "M instructions/s" << std::endl;
+	std::cout << "Lockstep: " << lockstepNs / laneInstructions << " ns/instruction, " << laneInstructions / lockstepNs * 1e3 << "M instructions/s, "
+		<< (double)laneInstructions / lockstep.getGroupSteps() << " lanes per group step" << std::endl;
+	std::cout << "Speedup: " << scalarNs / lockstepNs << "x" << std::endl;
+	return 0;
+}
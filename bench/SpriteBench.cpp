@@ -0,0 +1,141 @@
+/*
+
+CHP-8 Sprite Benchmark
+
+Compares drawing sprites into packed VRAM through blitSprite() (and each XOR kernel on its own) against a per-pixel
+reference that works the way MonoVideo used to: one bounds-checked bool per pixel. Both are run over the same
+sprites first and must leave identical screens and collision flags.
+
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+#include "../src/core/SpriteBlit.hpp"
+
+using namespace chp8;
+
+/****************************************************************
+			Per-pixel Reference
+****************************************************************/
+
+struct PixelScreen {
+	unsigned int width;
+	unsigned int height;
+	std::vector<bool> pixels;
+
+	bool invert(unsigned int x, unsigned int y) {
+		if (x >= width || y >= height)
+			return false;
+		bool wasOn = pixels[x + y * width];
+		pixels[x + y * width] = !wasOn;
+		return wasOn;
+	}
+
+	bool draw(unsigned int x, unsigned int y, const uint64_t* rows, unsigned int count, unsigned int spriteWidth) {
+		bool collided = false;
+		for (unsigned int row = 0; row < count; row++) {
+			for (unsigned int col = 0; col < spriteWidth; col++) {
+				if ((rows[row] >> (63 - col)) & 1)
+					collided |= invert(x + col, y + row);
+			}
+		}
+		return collided;
+	}
+};
+
+/****************************************************************
+			Benchmark
+****************************************************************/
+
+struct Sprite {
+	unsigned int x;
+	unsigned int y;
+	uint64_t rows[MaxSpriteRows];
+};
+
+static std::vector<Sprite> makeSprites(unsigned int width, unsigned int height, unsigned int spriteWidth, size_t count) {
+	std::mt19937_64 rng(8);
+	std::vector<Sprite> sprites(count);
+	for (Sprite& sprite : sprites) {
+		sprite.x = (unsigned int)(rng() % width);
+		sprite.y = (unsigned int)(rng() % height);
+		for (uint64_t& row : sprite.rows)
+			row = rng() & (~(uint64_t)0 << (64 - spriteWidth));
+	}
+	return sprites;
+}
+
+template <typename Draw> static double timeDraws(const std::vector<Sprite>& sprites, int passes, Draw draw) {
+	auto begin = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < passes; pass++) {
+		for (const Sprite& sprite : sprites)
+			draw(sprite);
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(end - begin).count() / ((double)passes * sprites.size());
+}
+
+static bool runCase(unsigned int width, unsigned int height, unsigned int spriteWidth, unsigned int rows, int passes) {
+	size_t wordsPerRow = width / 64;
+	std::vector<Sprite> sprites = makeSprites(width, height, spriteWidth, 1024);
+
+	// Check the packed path against the reference before timing anything
+	PixelScreen reference{ width, height, std::vector<bool>(width * height) };
+	std::vector<uint64_t> vram(wordsPerRow * height);
+	for (const Sprite& sprite : sprites) {
+		bool expected = reference.draw(sprite.x, sprite.y, sprite.rows, rows, spriteWidth);
+		bool actual = blitSprite(vram.data(), wordsPerRow, width, height, sprite.x, sprite.y, sprite.rows, rows);
+		if (expected != actual) {
+			std::cout << "Collision mismatch at " << sprite.x << "," << sprite.y << std::endl;
+			return false;
+		}
+	}
+	for (unsigned int y = 0; y < height; y++) {
+		for (unsigned int x = 0; x < width; x++) {
+			bool packed = (vram[y * wordsPerRow + x / 64] >> (63 - x % 64)) & 1;
+			if (packed != reference.pixels[x + y * width]) {
+				std::cout << "Pixel mismatch at " << x << "," << y << std::endl;
+				return false;
+			}
+		}
+	}
+
+	volatile bool sink = false;
+	double perPixel = timeDraws(sprites, passes, [&](const Sprite& s) { sink = reference.draw(s.x, s.y, s.rows, rows, spriteWidth); });
+	double packed = timeDraws(sprites, passes, [&](const Sprite& s) { sink = blitSprite(vram.data(), wordsPerRow, width, height, s.x, s.y, s.rows, rows); });
+
+	// The kernels alone, XORing a full sprite's worth of words at a fixed spot
+	size_t words = rows * wordsPerRow;
+	auto kernel = [&](XorBlitKernel k) {
+		return timeDraws(sprites, passes, [&](const Sprite& s) { sink = k(&vram[(s.y % (height - rows + 1)) * wordsPerRow], s.rows, words) != 0; });
+	};
+	double scalar = kernel(&xorBlitScalar);
+	double sse2 = kernel(&xorBlitSSE2);
+
+	std::cout << width << "x" << height << ", " << spriteWidth << "x" << rows << " sprites:" << std::endl;
+	std::cout << "  per-pixel reference: " << perPixel << " ns/sprite" << std::endl;
+	std::cout << "  blitSprite:          " << packed << " ns/sprite (" << perPixel / packed << "x)" << std::endl;
+	std::cout << "  scalar kernel:       " << scalar << " ns/sprite" << std::endl;
+	std::cout << "  SSE2 kernel:         " << sse2 << " ns/sprite" << std::endl;
+	if (hasAVX2())
+		std::cout << "  AVX2 kernel:         " << kernel(&xorBlitAVX2) << " ns/sprite" << std::endl;
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+	int passes = 2000;
+	if (argc > 1)
+		passes = std::atoi(argv[1]);
+
+	std::cout << std::fixed << std::setprecision(2);
+	bool ok = runCase(64, 32, 8, 15, passes);
+	ok = runCase(64, 64, 16, 16, passes) && ok;
+	ok = runCase(128, 64, 16, 16, passes) && ok;
+	return ok ? 0 : 1;
+}
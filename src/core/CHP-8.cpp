@@ -0,0 +1,1127 @@
+/*
+
+CHP-8
+
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#include "CHP-8.hpp"
+#include "Compression.hpp"
+#include "Font.hpp"
+#include "Operations.hpp"
+
+using namespace chp8;
+
+/****************************************************************
+			Chip8 Class : Constructors/Destructors
+****************************************************************/
+
+Chip8::Chip8(std::string conf, std::string romPath) {
+	framebuffer.setVideoMode(Framebuffer::_128x64);
+
+	// Drop any predecoded instruction or compiled block whose bytes get overwritten
+	memory.setWriteObserver([this](uint32_t index, uint32_t length) {
+		invalidateDecodeCache(index, index + length);
+		recompiler.invalidate(index, index + length);
+	});
+	loadFonts();
+
+	QuirkProfile profile;
+	if (!findQuirkProfile(conf, profile)) {
+		std::cout << "Unknown quirk profile \"" << conf << "\", using chip8" << std::endl;
+		profile = Cosmac;
+	}
+	setQuirkProfile(profile);
+
+	chipActive = true;
+}
+
+void Chip8::reset() {
+	std::memset(r, 0, sizeof(r));
+	r_sound = 0;
+	r_delay = 0;
+	r_I = 0;
+	pc = 0;
+	sp = 0;
+	std::memset(stack, 0, sizeof(stack));
+	keys = 0;
+	rngState = seedRandom(DefaultRandomSeed);
+	error = Chip8Error::None;
+	errorPC = 0;
+
+	// Clearing memory bypasses the write observer, so drop everything derived from it in one go
+	memory.clear();
+	loadFonts();
+	for (size_t i = 0; i < DecodeCacheSize; i++) {
+		decodeCache[i] = CachedInstruction();
+	}
+	recompiler.reset();
+	std::memset(codeModified, 0, sizeof(codeModified));
+
+	framebuffer.setVideoMode(Framebuffer::_128x64);
+
+	chipActive = true;
+}
+
+/****************************************************************
+			Chip8 Class : Ticking
+****************************************************************/
+
+int Chip8::runFrame(int cycles) {
+	int ran = beginFrame() ? execute(cycles) : 0;
+	endFrame();
+	return ran;
+}
+
+int Chip8::runFrameTimed(const CycleCosts& costs, int64_t& budget) {
+	int ran = 0;
+	if (beginFrame())
+		ran = executeTimed(costs, budget, std::numeric_limits<int>::max());
+	else
+		budget = 0; // Nothing ran, don't let the frame's cycles pile up
+	endFrame();
+	return ran;
+}
+
+bool Chip8::beginFrame() {
+	if (videoTest) {
+		if (videoTestMode)
+			test_videoInversionPatternTwo();
+		else
+			test_videoInversionPatternOne();
+		return false;
+	}
+	else {
+		// Check for errors
+		if (error != Chip8Error::None) {
+			// Exit with errors
+			chipActive = false;
+
+			std::cout << "Chip8 Error: ";
+			switch (error) {
+			case StackOverflow:
+				std::cout << "Stack Overflow!" << std::endl;
+				break;
+
+			case StackUnderflow:
+				std::cout << "Stack Underflow!" << std::endl;
+				break;
+
+			case UnknownOpcode:
+				std::cout << "Unknown Opcode!" << std::endl;
+				break;
+
+			case RecompilerMismatch:
+				std::cout << "Recompiler Mismatch!" << std::endl;
+				break;
+
+			default:
+				std::cout << "Unknown Type" << std::endl;
+				break;
+			}
+		}
+
+		return true;
+	}
+}
+
+void Chip8::endFrame() {
+	// The timers count down once a frame until they reach zero
+	if (r_delay > 0)
+		r_delay--;
+	if (r_sound > 0)
+		r_sound--;
+}
+
+/****************************************************************
+			Chip8 Class : Execution Control
+****************************************************************/
+
+void Chip8::setEngine(Engine e) {
+	engine = e;
+}
+
+Chip8::Engine Chip8::getEngine() {
+	return engine;
+}
+
+void Chip8::loadProgram(const uint8_t* program, size_t size, uint16_t address) {
+	// Addresses wrap, so stop at the end of memory rather than letting a long ROM overwrite the start
+	if (address < MemorySize)
+		memory.writeBlock(address, program, (uint32_t)std::min<size_t>(size, MemorySize - address));
+	pc = address;
+
+	// A compiled program was built from exactly these bytes, so nothing counts as modified yet
+	std::memset(codeModified, 0, sizeof(codeModified));
+}
+
+void Chip8::loadFonts() {
+	memory.writeBlock(FontAddress, smallFont, sizeof(smallFont));
+	memory.writeBlock(BigFontAddress, bigFont, sizeof(bigFont));
+}
+
+int Chip8::step() {
+	const CachedInstruction& cached = fetch();
+	(this->*cached.handler)(cached.in);
+	pc += 2;
+	return 1;
+}
+
+void Chip8::setCompiledProgram(CompiledProgram program) {
+	compiledProgram = program;
+}
+
+void Chip8::setTracer(Tracer* t) {
+	tracer = t;
+}
+
+void Chip8::setQuirkProfile(QuirkProfile profile) {
+	quirkProfile = profile;
+	switch (profile) {
+	case SuperChip:
+		handlers = handlerTable<SuperChipQuirks>;
+		break;
+
+	case XoChip:
+		handlers = handlerTable<XoChipQuirks>;
+		break;
+
+	default:
+		handlers = handlerTable<CosmacQuirks>;
+		break;
+	}
+
+	// Decodes hold the old profile's handlers and blocks were compiled for its quirks
+	for (size_t i = 0; i < DecodeCacheSize; i++) {
+		decodeCache[i].handler = nullptr;
+	}
+	recompiler.setQuirks(Quirks::of(profile));
+}
+
+QuirkProfile Chip8::getQuirkProfile() {
+	return quirkProfile;
+}
+
+Quirks Chip8::getQuirks() {
+	return Quirks::of(quirkProfile);
+}
+
+#if defined(CHP8_PROFILE)
+void Chip8::setProfiler(Profiler* p) {
+	profiler = p;
+}
+#endif
+
+#if defined(CHP8_MEMORY_CHECKS)
+void Chip8::addWatchpoint(uint16_t first, uint16_t last, bool reads, bool writes) {
+	typedef mem::Memory<MemorySize> Memory;
+	int access = (reads ? Memory::Read : 0) | (writes ? Memory::Write : 0);
+	if (access != 0)
+		memory.addWatchpoint(first, last, (Memory::Access)access);
+}
+
+void Chip8::clearWatchpoints() {
+	memory.clearWatchpoints();
+}
+#endif
+
+void Chip8::setKeys(uint16_t state) {
+	keys = state;
+}
+
+uint16_t Chip8::getKeys() {
+	return keys;
+}
+
+void Chip8::setSeed(uint32_t seed) {
+	rngState = seedRandom(seed);
+}
+
+int Chip8::execute(int count) {
+	// Only the interpreter sees every instruction individually
+	if (tracer != nullptr)
+		return runInterpreter(count);
+#if defined(CHP8_PROFILE)
+	if (profiler != nullptr)
+		return runInterpreter(count);
+#endif
+
+	switch (engine) {
+	case Threaded:
+		switch (quirkProfile) {
+		case SuperChip: return runThreaded<SuperChipQuirks>(count);
+		case XoChip: return runThreaded<XoChipQuirks>(count);
+		default: return runThreaded<CosmacQuirks>(count);
+		}
+
+	case Recompiled:
+		return runRecompiled(count, false);
+
+	case RecompiledDifferential:
+		return runRecompiled(count, true);
+
+	case Compiled:
+		return runCompiled(count);
+
+	default:
+		return runInterpreter(count);
+	}
+}
+
+/****************************************************************
+			Chip8 Class : Save States
+****************************************************************/
+
+const char Chip8::StateMagic[8] = { 'C', 'H', 'P', '8', 'S', 'A', 'V', '\0' };
+
+static_assert(sizeof(Chip8::StateHeader) == 24, "StateHeader is part of the save state format");
+
+bool Chip8::saveState(std::vector<uint8_t>& out, bool compress) {
+	static_assert(sizeof(StateCPU) == 80, "StateCPU is part of the save state format");
+
+	const uint8_t* mem = memory.getSpan(0, MemorySize);
+	if (mem == nullptr) {
+		std::cout << "Chip8::saveState() memory is unavailable" << std::endl;
+		return false;
+	}
+
+	StateCPU cpu = {};
+	std::memcpy(cpu.v, r, sizeof(r));
+	std::memcpy(cpu.stack, stack, sizeof(stack));
+	cpu.i = r_I;
+	cpu.pc = pc;
+	cpu.keys = keys;
+	cpu.sp = sp;
+	cpu.delay = r_delay;
+	cpu.sound = r_sound;
+	cpu.error = (uint8_t)error;
+	cpu.rng = rngState;
+	cpu.videoWidth = (uint16_t)framebuffer.getMode().width;
+	cpu.videoHeight = (uint16_t)framebuffer.getMode().height;
+	cpu.memorySize = MemorySize;
+	cpu.vramWords = (uint32_t)framebuffer.getWordCount();
+
+	size_t vramBytes = cpu.vramWords * sizeof(uint64_t);
+	statePayload.resize(sizeof(cpu) + MemorySize + vramBytes);
+	uint8_t* payload = statePayload.data();
+	std::memcpy(payload, &cpu, sizeof(cpu));
+	std::memcpy(payload + sizeof(cpu), mem, MemorySize);
+	std::memcpy(payload + sizeof(cpu) + MemorySize, framebuffer.getWords(), vramBytes);
+
+	StateHeader header = {};
+	std::memcpy(header.magic, StateMagic, sizeof(header.magic));
+	header.version = StateVersion;
+	header.payloadSize = (uint32_t)statePayload.size();
+
+	// Stored as is whenever compressing wouldn't make it smaller
+	size_t stored = 0;
+	if (compress) {
+		out.resize(sizeof(header) + compressBoundLZ4(statePayload.size()));
+		stored = compressLZ4(payload, statePayload.size(), out.data() + sizeof(header), out.size() - sizeof(header));
+	}
+	if (stored != 0 && stored < statePayload.size()) {
+		header.flags = StateCompressed;
+	}
+	else {
+		stored = statePayload.size();
+		out.resize(sizeof(header) + stored);
+		std::memcpy(out.data() + sizeof(header), payload, stored);
+	}
+	header.storedSize = (uint32_t)stored;
+	out.resize(sizeof(header) + stored);
+	std::memcpy(out.data(), &header, sizeof(header));
+	return true;
+}
+
+bool Chip8::loadState(const uint8_t* data, size_t size) {
+	StateHeader header;
+	if (size < sizeof(header)) {
+		std::cout << "Chip8::loadState() state is truncated" << std::endl;
+		return false;
+	}
+	std::memcpy(&header, data, sizeof(header));
+	if (std::memcmp(header.magic, StateMagic, sizeof(header.magic)) != 0) {
+		std::cout << "Chip8::loadState() not a CHP-8 save state" << std::endl;
+		return false;
+	}
+	if (header.version != StateVersion) {
+		std::cout << "Chip8::loadState() unsupported save state version " << header.version << std::endl;
+		return false;
+	}
+	if (header.storedSize != size - sizeof(header) || header.payloadSize < sizeof(StateCPU)) {
+		std::cout << "Chip8::loadState() state is truncated" << std::endl;
+		return false;
+	}
+
+	const uint8_t* payload = data + sizeof(header);
+	if (header.flags & StateCompressed) {
+		statePayload.resize(header.payloadSize);
+		if (!decompressLZ4(payload, header.storedSize, statePayload.data(), statePayload.size())) {
+			std::cout << "Chip8::loadState() state is corrupt" << std::endl;
+			return false;
+		}
+		payload = statePayload.data();
+	}
+	else if (header.storedSize != header.payloadSize) {
+		std::cout << "Chip8::loadState() state is truncated" << std::endl;
+		return false;
+	}
+
+	StateCPU cpu;
+	std::memcpy(&cpu, payload, sizeof(cpu));
+	if (cpu.memorySize != MemorySize || header.payloadSize != sizeof(cpu) + MemorySize + (size_t)cpu.vramWords * sizeof(uint64_t)
+		|| cpu.sp > 0x10 || cpu.error > RecompilerMismatch) {
+		std::cout << "Chip8::loadState() state doesn't fit this machine" << std::endl;
+		return false;
+	}
+
+	// VRAM first, it's the only part that can still be rejected
+	const uint8_t* savedMemory = payload + sizeof(cpu);
+	Framebuffer::VideoMode mode = { cpu.videoWidth, cpu.videoHeight };
+	const uint8_t* savedVram = savedMemory + MemorySize;
+	std::vector<uint64_t> words; // Only needed if the caller's buffer leaves VRAM unaligned
+	if (((uintptr_t)savedVram & (alignof(uint64_t) - 1)) != 0) {
+		words.resize(cpu.vramWords);
+		std::memcpy(words.data(), savedVram, words.size() * sizeof(uint64_t));
+		savedVram = (const uint8_t*)words.data();
+	}
+	if (!framebuffer.setWords(mode, (const uint64_t*)savedVram, cpu.vramWords)) {
+		std::cout << "Chip8::loadState() unsupported video mode " << cpu.videoWidth << "x" << cpu.videoHeight << std::endl;
+		return false;
+	}
+
+	// Write only what differs, so the observer drops just the decodes and blocks this state actually changes
+	const uint8_t* current = memory.getSpan(0, MemorySize);
+	const size_t Chunk = 64;
+	for (uint32_t base = 0; base < MemorySize; base += Chunk) {
+		if (std::memcmp(current + base, savedMemory + base, Chunk) == 0)
+			continue;
+		for (uint32_t index = base; index < base + Chunk; index++) {
+			if (current[index] != savedMemory[index])
+				memory.write(index, savedMemory[index]);
+		}
+	}
+
+	std::memcpy(r, cpu.v, sizeof(r));
+	std::memcpy(stack, cpu.stack, sizeof(stack));
+	r_I = cpu.i;
+	pc = cpu.pc;
+	keys = cpu.keys;
+	sp = cpu.sp;
+	r_delay = cpu.delay;
+	r_sound = cpu.sound;
+	error = (Chip8Error)cpu.error;
+	rngState = cpu.rng;
+
+	chipActive = true; // An errored state stops again on the next frame, as it did when it was saved
+	return true;
+}
+
+/****************************************************************
+			Chip8 Class : Misc
+****************************************************************/
+
+int chp8::interpretInstruction(Chip8& chip) {
+	return chip.step();
+}
+
+bool Chip8::isActive() {
+	return chipActive;
+}
+
+Chip8::Chip8Error Chip8::getError() {
+	return error;
+}
+
+uint16_t Chip8::getErrorPC() {
+	return errorPC;
+}
+
+uint8_t Chip8::getRegister(uint8_t index) {
+	return r[index & 0xF];
+}
+
+uint16_t Chip8::getI() {
+	return r_I;
+}
+
+uint16_t Chip8::getPC() {
+	return pc;
+}
+
+uint8_t Chip8::getSP() {
+	return sp;
+}
+
+uint16_t Chip8::getStackEntry(uint8_t index) {
+	return stack[index & 0xF];
+}
+
+uint8_t Chip8::getSoundTimer() {
+	return r_sound;
+}
+
+uint8_t Chip8::getDelayTimer() {
+	return r_delay;
+}
+
+Framebuffer& Chip8::getFramebuffer() {
+	return framebuffer;
+}
+
+/****************************************************************
+			Chip8 Class : (Private) Chip Errors
+****************************************************************/
+
+bool Chip8::hasErrored() {
+	return error != Chip8Error::None;
+}
+
+/****************************************************************
+			Chip8 Class : Stack
+****************************************************************/
+
+void Chip8::pushStack(uint16_t value) {
+	if (sp <= 0x0F) {
+		// Push to the stack
+		stack[sp] = value;
+		sp++;
+	}
+	else {
+		// Error!
+		error = Chip8Error::StackOverflow;
+		errorPC = pc;
+	}
+}
+
+uint16_t Chip8::popStack() {
+	if (sp == 0) {
+		// Nothing to return to
+		error = Chip8Error::StackUnderflow;
+		errorPC = pc;
+		return 0;
+	}
+	sp--;
+	return stack[sp];
+}
+
+uint16_t Chip8::peakStack() {
+	if (sp < 0)
+		error = Chip8Error::StackUnderflow;
+	else if (sp > 0xF)
+		error = Chip8Error::StackOverflow;
+	else
+		return stack[sp];
+	errorPC = pc;
+	return 0;
+}
+
+/****************************************************************
+			Chip8 Class : Decoding
+****************************************************************/
+
+template <typename Q> const Chip8::Handler Chip8::handlerTable[OpCount] = {
+	&Chip8::execute00E0, &Chip8::execute00EE, &Chip8::execute1NNN, &Chip8::execute2NNN, &Chip8::execute3XKK,
+	&Chip8::execute4XKK, &Chip8::execute5XY0, &Chip8::execute6XKK, &Chip8::execute7XKK,
+	&Chip8::execute8XY0, &Chip8::execute8XY1<Q>, &Chip8::execute8XY2<Q>, &Chip8::execute8XY3<Q>, &Chip8::execute8XY4,
+	&Chip8::execute8XY5, &Chip8::execute8XY6<Q>, &Chip8::execute8XY7, &Chip8::execute8XYE<Q>,
+	&Chip8::execute9XY0, &Chip8::executeANNN, &Chip8::executeBNNN<Q>, &Chip8::executeCXKK, &Chip8::executeDXYN<Q>,
+	&Chip8::executeEX9E, &Chip8::executeEXA1,
+	&Chip8::executeFX07, &Chip8::executeFX0A, &Chip8::executeFX15, &Chip8::executeFX18, &Chip8::executeFX1E,
+	&Chip8::executeFX29, &Chip8::executeFX30, &Chip8::executeFX33, &Chip8::executeFX55<Q>, &Chip8::executeFX65<Q>,
+	&Chip8::executeUnknown
+};
+
+const Chip8::CachedInstruction& Chip8::fetch() {
+	// Instructions at odd addresses can't live in the cache, decode them every time
+	if ((pc & 1) || (pc >> 1) >= DecodeCacheSize) {
+		uncachedInstruction.in = decode((memory.read(pc) << 8) | memory.read(pc + 1));
+		uncachedInstruction.handler = handlers[uncachedInstruction.in.op];
+		return uncachedInstruction;
+	}
+
+	CachedInstruction& cached = decodeCache[pc >> 1];
+	if (cached.handler == nullptr) {
+		cached.in = decode((memory.read(pc) << 8) | memory.read(pc + 1));
+		cached.handler = handlers[cached.in.op];
+	}
+	return cached;
+}
+
+void Chip8::invalidateDecodeCache(uint32_t first, uint32_t last) {
+	// A write to either byte of an even-aligned instruction invalidates it. Only the handler is cleared, so an
+	// instruction that overwrites itself can still read its own operands for the rest of its execution
+	if (first >= last)
+		return;
+	size_t end = std::min((size_t)((last + 1) >> 1), DecodeCacheSize);
+	for (size_t slot = first >> 1; slot < end; slot++) {
+		decodeCache[slot].handler = nullptr;
+		codeModified[slot] = 1;
+	}
+}
+
+/****************************************************************
+			Chip8 Class : Engines
+****************************************************************/
+
+int Chip8::runInterpreter(int count) {
+	// Pick the loop once per run, so an untraced, unprofiled run carries no tracing or profiling code at all
+#if defined(CHP8_PROFILE)
+	if (profiler != nullptr)
+		return tracer != nullptr ? runInterpreterLoop<true, true>(count) : runInterpreterLoop<false, true>(count);
+#endif
+	if (tracer != nullptr)
+		return runInterpreterLoop<true, false>(count);
+	return runInterpreterLoop<false, false>(count);
+}
+
+template <bool traced, bool profiled> int Chip8::runInterpreterLoop(int count) {
+	uint8_t before[0x10];
+	for (int i = 0; i < count; i++) {
+		// Get the decoded instruction at the current PC
+		const CachedInstruction& cached = fetch();
+		uint16_t address = pc;
+#if defined(CHP8_PROFILE)
+		uint8_t spBefore = sp;
+#endif
+		if (traced)
+			std::memcpy(before, r, sizeof(r));
+
+		// Process the instruction
+		(this->*cached.handler)(cached.in);
+
+		if (traced)
+			traceInstruction(cached.in, address, before);
+#if defined(CHP8_PROFILE)
+		if (profiled)
+			profileInstruction(cached.in, address, spBefore);
+#endif
+
+		pc += 2;
+	}
+	return count;
+}
+
+int Chip8::executeTimed(const CycleCosts& costs, int64_t& budget, int maxCount) {
+	// Always the interpreter, one instruction at a time, so the other engines never pay for the cost lookups
+	uint8_t before[0x10];
+	int ran = 0;
+	while (budget > 0 && ran < maxCount) {
+		const CachedInstruction& cached = fetch();
+		uint16_t address = pc;
+#if defined(CHP8_PROFILE)
+		uint8_t spBefore = sp;
+#endif
+		if (tracer != nullptr)
+			std::memcpy(before, r, sizeof(r));
+
+		(this->*cached.handler)(cached.in);
+
+		if (tracer != nullptr)
+			traceInstruction(cached.in, address, before);
+#if defined(CHP8_PROFILE)
+		if (profiler != nullptr)
+			profileInstruction(cached.in, address, spBefore);
+#endif
+
+		// A draw idles out the rest of this frame, then its cost comes out of the next
+		if (cached.in.op == OpDXYN && costs.drawWaitsForInterrupt && budget > 0)
+			budget = 0;
+		budget -= costs.cycles(cached.in, pc != address);
+
+		pc += 2;
+		ran++;
+	}
+	return ran;
+}
+
+template <typename Q> int Chip8::runThreaded(int count) {
+#if defined(__GNUC__)
+	// Every handler ends in its own copy of the dispatch, so each gets its own indirect branch history instead of
+	// all instructions sharing the single, badly predicted branch of a switch or handler call
+	static void* const labels[OpCount] = {
+		&&l00E0, &&l00EE, &&l1NNN, &&l2NNN, &&l3XKK, &&l4XKK, &&l5XY0, &&l6XKK, &&l7XKK,
+		&&l8XY0, &&l8XY1, &&l8XY2, &&l8XY3, &&l8XY4, &&l8XY5, &&l8XY6, &&l8XY7, &&l8XYE,
+		&&l9XY0, &&lANNN, &&lBNNN, &&lCXKK, &&lDXYN, &&lEX9E, &&lEXA1,
+		&&lFX07, &&lFX0A, &&lFX15, &&lFX18, &&lFX1E, &&lFX29, &&lFX30, &&lFX33, &&lFX55, &&lFX65, &&lUnknown
+	};
+
+	const Instruction* in;
+	int remaining = count;
+
+#define CHP8_DISPATCH() do { if (remaining-- <= 0) return count; in = &fetch().in; goto *labels[in->op]; } while (0)
+#define CHP8_NEXT() do { pc += 2; CHP8_DISPATCH(); } while (0)
+
+	CHP8_DISPATCH();
+
+l00E0: execute00E0(*in); CHP8_NEXT();
+l00EE: execute00EE(*in); CHP8_NEXT();
+l1NNN: execute1NNN(*in); CHP8_NEXT();
+l2NNN: execute2NNN(*in); CHP8_NEXT();
+l3XKK: execute3XKK(*in); CHP8_NEXT();
+l4XKK: execute4XKK(*in); CHP8_NEXT();
+l5XY0: execute5XY0(*in); CHP8_NEXT();
+l6XKK: execute6XKK(*in); CHP8_NEXT();
+l7XKK: execute7XKK(*in); CHP8_NEXT();
+l8XY0: execute8XY0(*in); CHP8_NEXT();
+l8XY1: execute8XY1<Q>(*in); CHP8_NEXT();
+l8XY2: execute8XY2<Q>(*in); CHP8_NEXT();
+l8XY3: execute8XY3<Q>(*in); CHP8_NEXT();
+l8XY4: execute8XY4(*in); CHP8_NEXT();
+l8XY5: execute8XY5(*in); CHP8_NEXT();
+l8XY6: execute8XY6<Q>(*in); CHP8_NEXT();
+l8XY7: execute8XY7(*in); CHP8_NEXT();
+l8XYE: execute8XYE<Q>(*in); CHP8_NEXT();
+l9XY0: execute9XY0(*in); CHP8_NEXT();
+lANNN: executeANNN(*in); CHP8_NEXT();
+lBNNN: executeBNNN<Q>(*in); CHP8_NEXT();
+lCXKK: executeCXKK(*in); CHP8_NEXT();
+lDXYN: executeDXYN<Q>(*in); CHP8_NEXT();
+lEX9E: executeEX9E(*in); CHP8_NEXT();
+lEXA1: executeEXA1(*in); CHP8_NEXT();
+lFX07: executeFX07(*in); CHP8_NEXT();
+lFX0A: executeFX0A(*in); CHP8_NEXT();
+lFX15: executeFX15(*in); CHP8_NEXT();
+lFX18: executeFX18(*in); CHP8_NEXT();
+lFX1E: executeFX1E(*in); CHP8_NEXT();
+lFX29: executeFX29(*in); CHP8_NEXT();
+lFX30: executeFX30(*in); CHP8_NEXT();
+lFX33: executeFX33(*in); CHP8_NEXT();
+lFX55: executeFX55<Q>(*in); CHP8_NEXT();
+lFX65: executeFX65<Q>(*in); CHP8_NEXT();
+lUnknown: executeUnknown(*in); CHP8_NEXT();
+
+#undef CHP8_NEXT
+#undef CHP8_DISPATCH
+#else
+	// Portable fallback without labels-as-values: dispatch through the handler pointers in the decode cache
+	for (int i = 0; i < count; i++) {
+		const CachedInstruction& cached = fetch();
+		(this->*cached.handler)(cached.in);
+		pc += 2;
+	}
+	return count;
+#endif
+}
+
+int Chip8::runRecompiled(int count, bool differential) {
+	int remaining = count;
+	while (remaining > 0) {
+		// Run a whole native block if there is one here and it fits in what's left of this tick
+		const Recompiler::Block& block = findBlock();
+		if (block.code != nullptr && block.length <= remaining) {
+			if (differential)
+				runBlockDifferential(block);
+			else
+				pc = (uint16_t)block.code(r, &r_I);
+			remaining -= block.length;
+			continue;
+		}
+
+		// Otherwise interpret a single instruction
+		const CachedInstruction& cached = fetch();
+		(this->*cached.handler)(cached.in);
+		pc += 2;
+		remaining--;
+	}
+	return count;
+}
+
+int Chip8::runCompiled(int count) {
+	if (compiledProgram == nullptr)
+		return runInterpreter(count);
+
+	CompiledContext context;
+	context.v = r;
+	context.i = &r_I;
+	context.pc = &pc;
+	context.modified = codeModified;
+	context.chip = this;
+	return compiledProgram(context, count);
+}
+
+/****************************************************************
+			Chip8 Class : Recompilation
+****************************************************************/
+
+const Recompiler::Block& Chip8::findBlock() {
+	static const Recompiler::Block noBlock;
+	if ((pc & 1) || (pc >> 1) >= Recompiler::BlockTableSize)
+		return noBlock;
+
+	const Recompiler::Block& block = recompiler.lookup(pc);
+	if (block.attempted)
+		return block;
+
+	// Gather instructions up to and including the first terminator, stopping early at anything not compilable
+	Instruction instructions[Recompiler::MaxBlockLength];
+	int length = 0;
+	for (uint32_t address = pc; length < Recompiler::MaxBlockLength && address + 1 < 0x1000; address += 2) {
+		Instruction in = decode((memory.read(address) << 8) | memory.read(address + 1));
+		if (!Recompiler::canCompile(in.op))
+			break;
+		instructions[length++] = in;
+		if (Recompiler::endsBlock(in.op))
+			break;
+	}
+	return recompiler.compile(pc, instructions, length);
+}
+
+void Chip8::runBlockDifferential(const Recompiler::Block& block) {
+	// Compiled blocks only touch V, I and PC, so those are all that need saving and comparing
+	uint8_t startR[0x10];
+	std::memcpy(startR, r, sizeof(r));
+	uint16_t startI = r_I;
+	uint16_t startPC = pc;
+
+	uint8_t nativeR[0x10];
+	std::memcpy(nativeR, r, sizeof(r));
+	uint16_t nativeI = r_I;
+	uint16_t nativePC = (uint16_t)block.code(nativeR, &nativeI);
+
+	// The interpreter's result is the one kept
+	for (int i = 0; i < block.length; i++) {
+		const CachedInstruction& cached = fetch();
+		(this->*cached.handler)(cached.in);
+		pc += 2;
+	}
+
+	if (std::memcmp(nativeR, r, sizeof(r)) != 0 || nativeI != r_I || nativePC != pc) {
+		std::cout << "Recompiled block at 0x" << std::hex << startPC << " (" << std::dec << (int)block.length
+			<< " instructions) diverged from the interpreter" << std::endl;
+		std::cout << "  start:       PC " << std::hex << startPC << " I " << startI << std::endl;
+		std::cout << "  interpreter: PC " << pc << " I " << r_I << std::endl;
+		std::cout << "  native:      PC " << nativePC << " I " << nativeI << std::endl;
+		for (int i = 0; i < 0x10; i++) {
+			if (nativeR[i] != r[i] || startR[i] != r[i])
+				std::cout << "  V" << i << ": start " << (int)startR[i] << " interpreter " << (int)r[i] << " native " << (int)nativeR[i] << std::endl;
+		}
+		std::cout << std::dec;
+		error = Chip8Error::RecompilerMismatch;
+		errorPC = startPC;
+	}
+}
+
+/****************************************************************
+			Chip8 Class : Tracing
+****************************************************************/
+
+void Chip8::traceInstruction(const Instruction& in, uint16_t address, const uint8_t* before) {
+	Tracer::Record record;
+	record.pc = address;
+	record.opcode = in.opcode;
+	record.i = r_I;
+	record.changed = 0;
+	std::memset(record.values, 0, sizeof(record.values));
+
+	int stored = 0;
+	for (int i = 0; i < 0x10; i++) {
+		if (r[i] == before[i])
+			continue;
+		record.changed |= 1 << i;
+		if (stored < 8)
+			record.values[stored++] = r[i];
+	}
+
+	tracer->record(record);
+}
+
+/****************************************************************
+			Chip8 Class : Profiling
+****************************************************************/
+
+#if defined(CHP8_PROFILE)
+void Chip8::profileInstruction(const Instruction& in, uint16_t address, uint8_t spBefore) {
+	profiler->count(in, address);
+
+	// A push means a call landed on PC + 2 (PC is only advanced after this), a pop means a return
+	if (sp > spBefore)
+		profiler->enter(pc + 2);
+	else if (sp < spBefore)
+		profiler->leave();
+}
+#endif
+
+/****************************************************************
+			Chip8 Class : Execution
+****************************************************************/
+
+void Chip8::executeCall(uint16_t target) {
+	// We need to set PC to target - 2. Also push the current PC to the stack, UNCHANGED so when it is
+	// popped back with the RET, the auto-increment allows us to execute correct next instruction
+	pushStack(pc);
+	if (!hasErrored()) {
+		pc = target - 2;
+	}
+	else {
+		std::cout << "Call interrupted due to stack error" << std::endl;
+	}
+}
+
+void Chip8::execute00E0(const Instruction& in) {
+	// CLS: clear the display
+	framebuffer.setAllPixels(false); // Set all the pixels to inactive
+}
+
+void Chip8::execute00EE(const Instruction& in) {
+	// RET: return from subroutine
+	uint16_t poppedValue = popStack(); // Pop the top value off the stack
+	// If we didn't error, set PC to the value we popped off the stack (points to the instruction that jumped, so when the PC is incremented
+	// we will be on the correct instruction to continue)
+	if (!hasErrored()) {
+		pc = poppedValue;
+	}
+}
+
+void Chip8::execute1NNN(const Instruction& in) {
+	// This is just a jump instruction with 0NNN giving the PC to jump to
+	// Set the PC to 0NNN - 2, as we need to execute the instruction at 0NNN even after the increment at the end of the cycle
+	pc = in.nnn - 2;
+}
+
+void Chip8::execute2NNN(const Instruction& in) {
+	// This is a call instruction to 0NNN giving the PC to jump to
+	// As with 1NNN, 
+	executeCall(in.nnn);
+}
+
+void Chip8::execute3XKK(const Instruction& in) {
+	// To do this skipping, do a pc += 2 in here, combined with the auto-increment
+	if (ops::skip3XKK(r, in.x, in.kk)) {
+		pc += 2;
+	}
+}
+
+void Chip8::execute4XKK(const Instruction& in) {
+	if (ops::skip4XKK(r, in.x, in.kk)) {
+		pc += 2;
+	}
+}
+
+void Chip8::execute5XY0(const Instruction& in) {
+	if (ops::skip5XY0(r, in.x, in.y)) {
+		pc += 2;
+	}
+}
+
+void Chip8::execute6XKK(const Instruction& in) {
+	ops::execute6XKK(r, in.x, in.kk);
+}
+
+void Chip8::execute7XKK(const Instruction& in) {
+	ops::execute7XKK(r, in.x, in.kk);
+}
+
+void Chip8::execute8XY0(const Instruction& in) {
+	ops::execute8XY0(r, in.x, in.y);
+}
+
+template <typename Q> void Chip8::execute8XY1(const Instruction& in) {
+	ops::execute8XY1<Q>(r, in.x, in.y);
+}
+
+template <typename Q> void Chip8::execute8XY2(const Instruction& in) {
+	ops::execute8XY2<Q>(r, in.x, in.y);
+}
+
+template <typename Q> void Chip8::execute8XY3(const Instruction& in) {
+	ops::execute8XY3<Q>(r, in.x, in.y);
+}
+
+void Chip8::execute8XY4(const Instruction& in) {
+	ops::execute8XY4(r, in.x, in.y);
+}
+
+void Chip8::execute8XY5(const Instruction& in) {
+	ops::execute8XY5(r, in.x, in.y);
+}
+
+template <typename Q> void Chip8::execute8XY6(const Instruction& in) {
+	ops::execute8XY6<Q>(r, in.x, in.y);
+}
+
+void Chip8::execute8XY7(const Instruction& in) {
+	ops::execute8XY7(r, in.x, in.y);
+}
+
+template <typename Q> void Chip8::execute8XYE(const Instruction& in) {
+	ops::execute8XYE<Q>(r, in.x, in.y);
+}
+
+void Chip8::execute9XY0(const Instruction& in) {
+	if (ops::skip9XY0(r, in.x, in.y)) {
+		pc += 2;
+	}
+}
+
+void Chip8::executeANNN(const Instruction& in) {
+	ops::executeANNN(r_I, in.nnn);
+}
+
+template <typename Q> void Chip8::executeBNNN(const Instruction& in) {
+	// Jump to V0 + 0NNN, or as BXNN to Vx + XNN
+	uint16_t target = (Q::jumpAddsVx ? r[in.x] : r[0x0]) + in.nnn;
+	pc = target - 2;
+}
+
+void Chip8::executeCXKK(const Instruction& in) {
+	// Vx = random AND kk, (Cxkk)
+	r[in.x] = nextRandomByte(rngState) & in.kk;
+}
+
+template <typename Q> void Chip8::executeDXYN(const Instruction& in) {
+	// Draw a n-byte sprite starting at I, with coordinates starting at (Vx,Vy), VF set if collision
+	// DXY0 draws a 16x16 sprite instead, two bytes per row
+	bool large = in.n == 0;
+	unsigned int count = large ? 16 : in.n;
+	uint32_t length = large ? 32 : count;
+
+	// Fetch the whole sprite in one go, only going byte by byte if it runs off the end of memory
+	uint8_t fallback[32];
+	const uint8_t* sprite = memory.getSpan(r_I, length);
+	if (sprite == nullptr) {
+		for (uint32_t i = 0; i < length; i++)
+			fallback[i] = memory.read(r_I + i);
+		sprite = fallback;
+	}
+
+	// Left align each row in a word
+	uint64_t rows[16];
+	for (unsigned int i = 0; i < count; i++) {
+		if (large)
+			rows[i] = (uint64_t)((sprite[i * 2] << 8) | sprite[i * 2 + 1]) << 48;
+		else
+			rows[i] = (uint64_t)sprite[i] << 56;
+	}
+
+	// The starting position wraps, the sprite itself is clipped at the edges unless the profile wraps it too
+	Framebuffer::VideoMode mode = framebuffer.getMode();
+	unsigned int x = r[in.x] % mode.width;
+	unsigned int y = r[in.y] % mode.height;
+	if (Q::spritesWrap)
+		r[0xF] = framebuffer.xorSpriteWrapped(x, y, rows, count) ? 1 : 0;
+	else
+		r[0xF] = framebuffer.xorSprite(x, y, rows, count) ? 1 : 0;
+}
+
+void Chip8::executeEX9E(const Instruction& in) {
+	// Skip next instruction if key with value Vx is pressed
+	if ((keys >> (r[in.x] & 0xF)) & 1)
+		pc += 2;
+}
+
+void Chip8::executeEXA1(const Instruction& in) {
+	// Skip next instruction if key with value Vx is not pressed
+	if (!((keys >> (r[in.x] & 0xF)) & 1))
+		pc += 2;
+}
+
+void Chip8::executeFX07(const Instruction& in) {
+	// Set Vx = delay timer
+	r[in.x] = r_delay;
+}
+
+void Chip8::executeFX0A(const Instruction& in) {
+	// Wait for a key press and put the lowest key held in Vx. Waiting runs this same instruction again
+	if (keys == 0) {
+		pc -= 2;
+		return;
+	}
+	uint8_t key = 0;
+	while (((keys >> key) & 1) == 0)
+		key++;
+	r[in.x] = key;
+}
+
+void Chip8::executeFX15(const Instruction& in) {
+	// Set delay timer = Vx
+	r_delay = r[in.x];
+}
+
+void Chip8::executeFX18(const Instruction& in) {
+	// Set sound timer = Vx
+	r_sound = r[in.x];
+}
+
+void Chip8::executeFX1E(const Instruction& in) {
+	ops::executeFX1E(r_I, r, in.x);
+}
+
+void Chip8::executeFX29(const Instruction& in) {
+	ops::executeFX29(r_I, r, in.x);
+}
+
+void Chip8::executeFX30(const Instruction& in) {
+	ops::executeFX30(r_I, r, in.x);
+}
+
+void Chip8::executeFX33(const Instruction& in) {
+	// Store the decimal digits of Vx at I, I + 1 and I + 2
+	uint8_t digits[3];
+	ops::decimalDigits(r[in.x], digits);
+	memory.writeBlock(r_I, digits, 3);
+}
+
+template <typename Q> void Chip8::executeFX55(const Instruction& in) {
+	// Store V0 to Vx at I onwards
+	memory.writeBlock(r_I, r, in.x + 1);
+	if (Q::loadStoreIncrementsI)
+		r_I += in.x + 1;
+}
+
+template <typename Q> void Chip8::executeFX65(const Instruction& in) {
+	// Load V0 to Vx from I onwards
+	memory.readBlock(r_I, r, in.x + 1);
+	if (Q::loadStoreIncrementsI)
+		r_I += in.x + 1;
+}
+
+void Chip8::executeUnknown(const Instruction& in) {
+	// Flag the unknown opcode error
+	error = Chip8Error::UnknownOpcode;
+	errorPC = pc;
+}
+
+/****************************************************************
+			Chip8 Class : Video Test
+****************************************************************/
+
+void Chip8::test_videoInversionPattern(int xInc, int yInc) {
+	framebuffer.invertPixel(ix, iy);
+	ix += xInc;
+	if (ix >= framebuffer.getMode().width) {
+		ix = 0; iy += yInc;
+	}
+	if (iy >= framebuffer.getMode().height) {
+		iy = 0;
+		framebuffer.invertAllPixels();
+		videoTestMode = !videoTestMode;
+	}
+}
+
+bool Chip8::test_videoInversionPatternDue(int microseconds) {
+	auto now = std::chrono::steady_clock::now();
+	if (now - test_videoInversionPatternTime < std::chrono::microseconds(microseconds))
+		return false;
+
+	test_videoInversionPatternTime = now;
+	return true;
+}
+
+void Chip8::test_videoInversionPatternOne() {
+	if (!test_videoInversionPatternDue(200))
+		return;
+
+	test_videoInversionPattern(2, 2);
+}
+
+void Chip8::test_videoInversionPatternTwo() {
+	if (!test_videoInversionPatternDue(100))
+		return;
+
+	test_videoInversionPattern(1, 3);
+}
\ No newline at end of file
@@ -0,0 +1,341 @@
+#pragma once
+/*
+
+CHP-8
+
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "CompiledProgram.hpp"
+#include "CycleCosts.hpp"
+#include "Framebuffer.hpp"
+#include "Instruction.hpp"
+#include "Memory.hpp"
+#include "Profiler.hpp"
+#include "Quirks.hpp"
+#include "Random.hpp"
+#include "Recompiler.hpp"
+#include "Tracer.hpp"
+
+namespace chp8 {
+
+	/****************************************************************
+			Chip8 Class
+	****************************************************************/
+
+	/*
+	The emulated machine: CPU, memory and framebuffer. It has no display or window of its own, frontends observe it
+	through the accessors below
+	*/
+	class Chip8 {
+	public:
+		enum Chip8Error { None, StackUnderflow, StackOverflow, UnknownOpcode, RecompilerMismatch };
+
+		/*
+		Execution engines. The interpreter engines run the same handlers over the same decode cache and differ only
+		in how they dispatch from one instruction to the next. Recompiled runs native blocks where it can and the
+		interpreter elsewhere, RecompiledDifferential runs every block on both and stops on the first difference.
+		Compiled runs the program set with setCompiledProgram()
+		*/
+		enum Engine { Interpreter, Threaded, Recompiled, RecompiledDifferential, Compiled };
+
+		/*
+		conf names the quirk profile to run with, see Quirks.hpp. Anything else runs chip8 after a message
+		*/
+		Chip8(std::string conf, std::string romPath);
+
+		/*
+		Returns the machine to its power-on state: registers, stack, memory, VRAM and every cache. Nothing is
+		reallocated, so one instance can run any number of programs back to back
+		*/
+		void reset();
+
+		/*
+		Ticking. One call is one 60Hz frame: reports any error, runs cycles instructions and steps the timers.
+		Returns the number of instructions run. Scheduler decides how many frames to run and how long they are
+		*/
+		int runFrame(int cycles);
+
+		/*
+		As runFrame(), but runs instructions charged by costs until budget, in machine cycles, runs out. An
+		instruction that overruns is paid for from the next frame: budget is left at zero or below, for the caller to
+		add the next frame's cycles to
+		*/
+		int runFrameTimed(const CycleCosts& costs, int64_t& budget);
+
+		/*
+		Execution
+		*/
+		void setEngine(Engine e);
+		Engine getEngine();
+		void loadProgram(const uint8_t* program, size_t size, uint16_t address = 0x200);
+		int execute(int count); // Runs count instructions on the selected engine and returns count, errors don't stop it
+		int step(); // Runs the single instruction at PC on the interpreter, returns 1
+		int executeTimed(const CycleCosts& costs, int64_t& budget, int maxCount); // Interpreter only, see runFrameTimed()
+		void setCompiledProgram(CompiledProgram program); // Generated by tools/StaticRecompiler.cpp for the loaded ROM
+		void setTracer(Tracer* t); // nullptr stops tracing. While tracing, every engine runs as the interpreter
+		void setQuirkProfile(QuirkProfile profile); // Switches to the handlers and threaded engine built for profile
+		QuirkProfile getQuirkProfile();
+		Quirks getQuirks(); // The profile's flags, to set up a Lockstep or recompiler the same way
+#if defined(CHP8_PROFILE)
+		void setProfiler(Profiler* p); // nullptr stops profiling. While profiling, every engine runs as the interpreter
+#endif
+#if defined(CHP8_MEMORY_CHECKS)
+		void addWatchpoint(uint16_t first, uint16_t last, bool reads, bool writes); // Inclusive range, hits are printed
+		void clearWatchpoints();
+#endif
+
+		/*
+		Save states. A state is a StateHeader followed by the payload, LZ4 compressed when the header's flags say so.
+		The payload is the CPU (registers, I, PC, SP, stack, timers, keypad, error and RNG), all of memory and VRAM
+		with its mode, in host byte order. Caches are never saved: loading writes only the bytes of memory that
+		differ, so only what those bytes decoded to is dropped. saveState() replaces out's contents and reuses its
+		capacity, so saving every frame into the same vector doesn't allocate. A state that fails to load changes
+		nothing
+		*/
+		struct StateHeader {
+			char magic[8];
+			uint16_t version;
+			uint16_t flags;
+			uint32_t payloadSize; // Uncompressed
+			uint32_t storedSize; // Bytes following the header
+			uint32_t reserved;
+		};
+		static const char StateMagic[8];
+		static const uint16_t StateVersion = 1;
+		static const uint16_t StateCompressed = 1; // Flag
+
+		bool saveState(std::vector<uint8_t>& out, bool compress = true);
+		bool loadState(const uint8_t* data, size_t size);
+
+		/*
+		Input. Bit n set means key n of the hex keypad is held
+		*/
+		void setKeys(uint16_t state);
+		uint16_t getKeys();
+
+		/*
+		Seeds the generator CXKK draws from. reset() puts it back to DefaultRandomSeed
+		*/
+		void setSeed(uint32_t seed);
+
+		/*
+		Misc
+		*/
+		bool isActive();
+		Chip8Error getError();
+		uint16_t getErrorPC(); // The instruction that raised the error, for a RecompilerMismatch the start of its block
+
+		uint8_t getRegister(uint8_t index);
+		uint16_t getI();
+		uint16_t getPC();
+		uint8_t getSP();
+		uint16_t getStackEntry(uint8_t index);
+		uint8_t getSoundTimer();
+		uint8_t getDelayTimer();
+
+		Framebuffer& getFramebuffer();
+
+	private:
+		/*
+		16 8-bit registers.
+		0 through E are general purpose, F is the flag register
+		*/
+		uint8_t r[0x10]{};
+
+		/*
+		Two specific-purpose registers, Sound and Delay. When non-zero, they are decremented at 60Hz
+		*/
+		uint8_t r_sound = 0;
+		uint8_t r_delay = 0;
+
+		/*
+		I register
+		*/
+		uint16_t r_I = 0;
+
+		/*
+		Internal state
+		*/
+		uint16_t pc = 0; // Program counter
+		uint8_t sp = 0; // Stack pointer
+		bool chipActive = false;
+
+		/*
+		Keypad state, bit n for key n
+		*/
+		uint16_t keys = 0;
+
+		uint32_t rngState = DefaultRandomSeed; // CXKK
+
+		/*
+		Chip Errors
+		*/
+		Chip8Error error = Chip8Error::None;
+		uint16_t errorPC = 0;
+
+		bool hasErrored();
+
+		/*
+		Stack
+		*/
+		uint16_t stack[0x10]{}; // 16 levels of stack
+
+		void pushStack(uint16_t value);
+		uint16_t popStack();
+		uint16_t peakStack();
+
+		/*
+		Memory
+		*/
+		static const uint32_t MemorySize = 0x1000;
+		mem::Memory<MemorySize> memory; // 4KB of memory
+		void loadFonts(); // Into the reserved memory below 0x200, see Font.hpp
+		Framebuffer framebuffer; // VRAM
+
+		/*
+		Save states. The fixed part of the payload, followed by memory and then VRAM
+		*/
+		struct StateCPU {
+			uint8_t v[0x10];
+			uint16_t stack[0x10];
+			uint16_t i;
+			uint16_t pc;
+			uint16_t keys;
+			uint16_t videoWidth;
+			uint16_t videoHeight;
+			uint8_t sp;
+			uint8_t delay;
+			uint8_t sound;
+			uint8_t error;
+			uint16_t reserved;
+			uint32_t rng;
+			uint32_t memorySize;
+			uint32_t vramWords;
+			uint32_t alignment; // Keeps VRAM, after memory, 8 byte aligned in the payload
+		};
+		std::vector<uint8_t> statePayload; // Scratch for the uncompressed payload
+
+		/*
+		Execution
+		*/
+		typedef void (Chip8::*Handler)(const Instruction& in);
+		template <typename Q> static const Handler handlerTable[OpCount]; // Indexed by Operation, one per quirk profile
+		const Handler* handlers = nullptr; // The table for the current profile
+
+		/*
+		Predecoded instruction cache, one entry per even address. Entries are filled lazily on first execution and
+		dropped whenever memory under them is written
+		*/
+		struct CachedInstruction {
+			Handler handler = nullptr; // nullptr marks an undecoded (or invalidated) entry
+			Instruction in;
+		};
+		static const size_t DecodeCacheSize = 0x800;
+		CachedInstruction decodeCache[DecodeCacheSize];
+		CachedInstruction uncachedInstruction; // Holds the decode of an instruction at an odd (uncacheable) address
+
+		Engine engine = Engine::Interpreter;
+		Tracer* tracer = nullptr;
+		QuirkProfile quirkProfile = Cosmac;
+
+		const CachedInstruction& fetch();
+		bool beginFrame(); // Reports errors, false if the frame shouldn't run any instructions
+		void endFrame();
+		void invalidateDecodeCache(uint32_t first, uint32_t last); // Bytes [first, last), also marks them in codeModified
+
+		int runInterpreter(int count);
+		template <bool traced, bool profiled> int runInterpreterLoop(int count);
+		template <typename Q> int runThreaded(int count);
+		int runRecompiled(int count, bool differential);
+
+		/*
+		Recompilation
+		*/
+		Recompiler recompiler;
+
+		const Recompiler::Block& findBlock();
+		void runBlockDifferential(const Recompiler::Block& block);
+
+		/*
+		Tracing
+		*/
+		void traceInstruction(const Instruction& in, uint16_t address, const uint8_t* before);
+
+		/*
+		Profiling, only built with CHP8_PROFILE
+		*/
+#if defined(CHP8_PROFILE)
+		Profiler* profiler = nullptr;
+
+		void profileInstruction(const Instruction& in, uint16_t address, uint8_t spBefore);
+#endif
+
+		/*
+		Ahead-of-time compiled program
+		*/
+		CompiledProgram compiledProgram = nullptr;
+		uint8_t codeModified[DecodeCacheSize]{}; // Per even address, set by any write after loadProgram()
+
+		int runCompiled(int count);
+
+		void executeCall(uint16_t target);
+
+		// Handlers for instructions whose behaviour depends on the quirk profile are instantiated once per profile
+
+		void execute00E0(const Instruction& in);
+		void execute00EE(const Instruction& in);
+		void execute1NNN(const Instruction& in);
+		void execute2NNN(const Instruction& in);
+		void execute3XKK(const Instruction& in);
+		void execute4XKK(const Instruction& in);
+		void execute5XY0(const Instruction& in);
+		void execute6XKK(const Instruction& in);
+		void execute7XKK(const Instruction& in);
+		void execute8XY0(const Instruction& in);
+		template <typename Q> void execute8XY1(const Instruction& in);
+		template <typename Q> void execute8XY2(const Instruction& in);
+		template <typename Q> void execute8XY3(const Instruction& in);
+		void execute8XY4(const Instruction& in);
+		void execute8XY5(const Instruction& in);
+		template <typename Q> void execute8XY6(const Instruction& in);
+		void execute8XY7(const Instruction& in);
+		template <typename Q> void execute8XYE(const Instruction& in);
+		void execute9XY0(const Instruction& in);
+		void executeANNN(const Instruction& in);
+		template <typename Q> void executeBNNN(const Instruction& in);
+		void executeCXKK(const Instruction& in);
+		template <typename Q> void executeDXYN(const Instruction& in);
+		void executeEX9E(const Instruction& in);
+		void executeEXA1(const Instruction& in);
+		void executeFX07(const Instruction& in);
+		void executeFX0A(const Instruction& in);
+		void executeFX15(const Instruction& in);
+		void executeFX18(const Instruction& in);
+		void executeFX1E(const Instruction& in);
+		void executeFX29(const Instruction& in);
+		void executeFX30(const Instruction& in);
+		void executeFX33(const Instruction& in);
+		template <typename Q> void executeFX55(const Instruction& in);
+		template <typename Q> void executeFX65(const Instruction& in);
+		void executeUnknown(const Instruction& in);
+
+		/*
+		Test functions
+		*/
+		int ix = 0;
+		int iy = 0;
+		bool videoTest = false;
+		bool videoTestMode = false;
+		void test_videoInversionPattern(int xInc, int yInc); std::chrono::steady_clock::time_point test_videoInversionPatternTime;
+		bool test_videoInversionPatternDue(int microseconds);
+		void test_videoInversionPatternOne();
+		void test_videoInversionPatternTwo();
+
+	};
+
+}
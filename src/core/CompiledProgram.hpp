@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+namespace chp8 {
+
+	class Chip8;
+
+	/****************************************************************
+			Ahead-of-time Compiled Programs
+	****************************************************************/
+
+	/*
+	What a program generated by tools/StaticRecompiler.cpp gets to work with. The pointers refer straight into the
+	running Chip8, so compiled blocks and the interpreter trampoline see each other's changes immediately
+	*/
+	struct CompiledContext {
+		uint8_t* v; // V0..VF
+		uint16_t* i; // I register
+		uint16_t* pc; // Program counter
+		const uint8_t* modified; // One flag per even address, set once the code there has been written since loading
+		Chip8* chip; // For the interpreter trampoline
+	};
+
+	/*
+	Runs count instructions, returns the number run. Anything the program has no compiled block for goes through
+	interpretInstruction()
+	*/
+	typedef int (*CompiledProgram)(CompiledContext& context, int count);
+
+	/*
+	Interpreter trampoline, runs the single instruction at the current PC and returns 1
+	*/
+	int interpretInstruction(Chip8& chip);
+
+}
@@ -0,0 +1,189 @@
+#include "Compression.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace chp8;
+
+static const int HashLog = 12;
+static const size_t MinMatch = 4;
+static const size_t LastLiterals = 5; // The block always ends in at least this many literals
+static const size_t MatchStartLimit = 12; // and no match starts within this many bytes of its end
+static const size_t MaxOffset = 0xFFFF;
+
+static uint32_t read32(const uint8_t* p) {
+	uint32_t value;
+	std::memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static uint64_t read64(const uint8_t* p) {
+	uint64_t value;
+	std::memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static uint32_t hashSequence(uint32_t sequence) {
+	return (sequence * 2654435761u) >> (32 - HashLog);
+}
+
+/*
+Lengths past what fits in a token nibble continue in bytes of 255 and a final remainder
+*/
+static uint8_t* writeLength(uint8_t* op, size_t length) {
+	for (length -= 15; length >= 255; length -= 255)
+		*op++ = 255;
+	*op++ = (uint8_t)length;
+	return op;
+}
+
+static bool readLength(const uint8_t*& ip, const uint8_t* end, size_t& length) {
+	uint8_t b;
+	do {
+		if (ip >= end)
+			return false;
+		b = *ip++;
+		length += b;
+	} while (b == 255);
+	return true;
+}
+
+/*
+One sequence: a token, literalCount literals, then unless this is the last one a 16-bit offset and the match
+length beyond MinMatch. Returns false if it wouldn't fit before end
+*/
+static bool writeSequence(uint8_t*& op, uint8_t* end, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength) {
+	size_t needed = 1 + literalCount / 255 + 1 + literalCount + 2 + matchLength / 255 + 1;
+	if (needed > (size_t)(end - op))
+		return false;
+
+	uint8_t* token = op++;
+	*token = (uint8_t)((literalCount < 15 ? literalCount : 15) << 4);
+	if (literalCount >= 15)
+		op = writeLength(op, literalCount);
+	std::memcpy(op, literals, literalCount);
+	op += literalCount;
+
+	if (matchLength == 0) // Last sequence
+		return true;
+
+	*op++ = (uint8_t)offset;
+	*op++ = (uint8_t)(offset >> 8);
+	matchLength -= MinMatch;
+	*token |= (uint8_t)(matchLength < 15 ? matchLength : 15);
+	if (matchLength >= 15)
+		op = writeLength(op, matchLength);
+	return true;
+}
+
+/****************************************************************
+			LZ4 Block Compression
+****************************************************************/
+
+size_t chp8::compressBoundLZ4(size_t size) {
+	return size + size / 255 + 16;
+}
+
+size_t chp8::compressLZ4(const uint8_t* source, size_t size, uint8_t* destination, size_t capacity) {
+	const uint8_t* ip = source;
+	const uint8_t* anchor = source; // Start of the literals not yet written
+	const uint8_t* end = source + size;
+	uint8_t* op = destination;
+	uint8_t* opEnd = destination + capacity;
+
+	if (size > MatchStartLimit) {
+		const uint8_t* matchStartEnd = end - MatchStartLimit;
+		const uint8_t* matchEnd = end - LastLiterals;
+		uint32_t table[1 << HashLog] = {}; // Offset from source of the last position with each hash
+
+		while (ip <= matchStartEnd) {
+			uint32_t h = hashSequence(read32(ip));
+			const uint8_t* candidate = source + table[h];
+			table[h] = (uint32_t)(ip - source);
+			if (candidate >= ip || (size_t)(ip - candidate) > MaxOffset || read32(candidate) != read32(ip)) {
+				ip++;
+				continue;
+			}
+
+			// Grow the match backwards into the pending literals, then forwards a word at a time
+			while (ip > anchor && candidate > source && ip[-1] == candidate[-1]) {
+				ip--;
+				candidate--;
+			}
+			const uint8_t* mp = ip + MinMatch;
+			const uint8_t* cp = candidate + MinMatch;
+			uint64_t diff = 0;
+			while (mp + 8 <= matchEnd && (diff = read64(mp) ^ read64(cp)) == 0) {
+				mp += 8;
+				cp += 8;
+			}
+			if (diff != 0) {
+				mp += __builtin_ctzll(diff) >> 3;
+			}
+			else {
+				while (mp < matchEnd && *mp == *cp) {
+					mp++;
+					cp++;
+				}
+			}
+
+			if (!writeSequence(op, opEnd, anchor, ip - anchor, ip - candidate, mp - ip))
+				return 0;
+			ip = mp;
+			anchor = ip;
+			table[hashSequence(read32(ip - 2))] = (uint32_t)(ip - 2 - source);
+		}
+	}
+
+	if (!writeSequence(op, opEnd, anchor, end - anchor, 0, 0))
+		return 0;
+	return op - destination;
+}
+
+bool chp8::decompressLZ4(const uint8_t* source, size_t sourceSize, uint8_t* destination, size_t size) {
+	const uint8_t* ip = source;
+	const uint8_t* end = source + sourceSize;
+	uint8_t* op = destination;
+	uint8_t* opEnd = destination + size;
+
+	while (ip < end) {
+		uint8_t token = *ip++;
+
+		size_t literalCount = token >> 4;
+		if (literalCount == 15 && !readLength(ip, end, literalCount))
+			return false;
+		if (literalCount > (size_t)(end - ip) || literalCount > (size_t)(opEnd - op))
+			return false;
+		std::memcpy(op, ip, literalCount);
+		ip += literalCount;
+		op += literalCount;
+
+		if (ip == end) // The last sequence has no match
+			return op == opEnd;
+
+		if (end - ip < 2)
+			return false;
+		size_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > (size_t)(op - destination))
+			return false;
+
+		size_t matchLength = token & 15;
+		if (matchLength == 15 && !readLength(ip, end, matchLength))
+			return false;
+		matchLength += MinMatch;
+		if (matchLength > (size_t)(opEnd - op))
+			return false;
+
+		// Matches may overlap what they produce (a run of one byte is offset 1). The output repeats every offset
+		// bytes from the match on, so each copy can take everything written so far and the copies double
+		const uint8_t* match = op - offset;
+		for (size_t copied = 0; copied < matchLength;) {
+			size_t n = std::min(offset + copied, matchLength - copied);
+			std::memcpy(op + copied, match, n);
+			copied += n;
+		}
+		op += matchLength;
+	}
+	return false;
+}
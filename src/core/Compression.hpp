@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace chp8 {
+
+	/****************************************************************
+			LZ4 Block Compression
+	****************************************************************/
+
+	/*
+	The LZ4 block format: sequences of a token, literals and a back reference of at least 4 bytes within the last
+	64KB. The compressor is the single pass greedy one with a hash table of 4 byte sequences, which is plenty for
+	save states where most of memory and VRAM is zero. Its output decodes with any LZ4 block decoder
+	*/
+
+	/*
+	The most compressLZ4() can produce from size bytes, however badly they compress
+	*/
+	size_t compressBoundLZ4(size_t size);
+
+	/*
+	Compresses size bytes into at most capacity bytes. Returns the compressed size, or 0 if it didn't fit
+	*/
+	size_t compressLZ4(const uint8_t* source, size_t size, uint8_t* destination, size_t capacity);
+
+	/*
+	Decompresses a block that must expand to exactly size bytes. Returns false on malformed input, never reading
+	or writing out of bounds
+	*/
+	bool decompressLZ4(const uint8_t* source, size_t sourceSize, uint8_t* destination, size_t size);
+
+}
@@ -0,0 +1,40 @@
+#include "CycleCosts.hpp"
+
+using namespace chp8;
+
+/****************************************************************
+			Cycle Costs
+****************************************************************/
+
+// Every instruction first goes through the interpreter's fetch and decode loop
+static const uint16_t Fetch = 40;
+
+const CycleCosts chp8::vipCycleCosts = {
+	3668, // frameCycles
+	128 * 8 + 32, // interruptCycles: DMA of 8 bytes for each of 128 scanlines, then the interrupt routine
+	{
+		Fetch + 3078, Fetch + 10, Fetch + 12, Fetch + 26, // 00E0 00EE 1NNN 2NNN
+		Fetch + 10, Fetch + 10, Fetch + 14, Fetch + 6, Fetch + 10, // 3XKK 4XKK 5XY0 6XKK 7XKK
+		Fetch + 44, Fetch + 44, Fetch + 44, Fetch + 44, Fetch + 44, // 8XY0 8XY1 8XY2 8XY3 8XY4
+		Fetch + 44, Fetch + 44, Fetch + 44, Fetch + 44, // 8XY5 8XY6 8XY7 8XYE
+		Fetch + 14, Fetch + 12, Fetch + 22, Fetch + 36, Fetch + 26, // 9XY0 ANNN BNNN CXKK DXYN
+		Fetch + 14, Fetch + 14, // EX9E EXA1
+		Fetch + 10, Fetch + 18, Fetch + 10, Fetch + 10, Fetch + 16, // FX07 FX0A FX15 FX18 FX1E
+		Fetch + 20, Fetch + 20, Fetch + 84, Fetch + 14, Fetch + 14, // FX29 FX30 FX33 FX55 FX65
+		Fetch // Unknown
+	},
+	{
+		0, 0, 0, 0,
+		4, 4, 4, 0, 0, // 3XKK 4XKK 5XY0
+		0, 0, 0, 0, 0,
+		0, 0, 0, 0,
+		4, 0, 0, 0, 0, // 9XY0
+		4, 4, // EX9E EXA1
+		0, 0, 0, 0, 0,
+		0, 0, 0, 0, 0,
+		0
+	},
+	46, // perSpriteRow
+	14, // perRegister
+	true // drawWaitsForInterrupt
+};
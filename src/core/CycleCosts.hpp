@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Instruction.hpp"
+
+namespace chp8 {
+
+	/****************************************************************
+			Cycle Costs
+	****************************************************************/
+
+	/*
+	What each instruction costs in machine cycles of some original machine, for Scheduler to time frames by
+	instead of counting instructions. A frame is frameCycles long, of which the display and the 60Hz interrupt take
+	interruptCycles before the CPU sees any. An instruction costs its base, plus taken[] when it skips, plus its
+	rows or registers where it has them
+	*/
+	struct CycleCosts {
+		uint32_t frameCycles; // Between two 60Hz interrupts
+		uint32_t interruptCycles; // Taken from every frame by display DMA and the interrupt routine
+		uint16_t base[OpCount]; // Fetch, decode and execute, indexed by Operation
+		uint16_t taken[OpCount]; // Extra for a skip that skips
+		uint16_t perSpriteRow; // DXYN
+		uint16_t perRegister; // FX55 and FX65, for each register transferred
+		bool drawWaitsForInterrupt; // DXYN idles until the next interrupt and draws in the frame after it
+
+		uint32_t cycles(const Instruction& in, bool skipped) const {
+			uint32_t total = base[in.op] + (skipped ? taken[in.op] : 0);
+			if (in.op == OpDXYN)
+				total += perSpriteRow * (in.n == 0 ? 16 : in.n);
+			else if (in.op == OpFX55 || in.op == OpFX65)
+				total += perRegister * (in.x + 1);
+			return total;
+		}
+	};
+
+	/*
+	The COSMAC VIP: 1.76MHz, 8 clocks a machine cycle, so 3668 machine cycles a frame. The costs are those of its
+	CHIP-8 interpreter's routines, approximate where they depend on the data (FX33 on the digits, DXYN on how the
+	sprite lines up with bytes) and averaged there
+	*/
+	extern const CycleCosts vipCycleCosts;
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+namespace chp8 {
+
+	/****************************************************************
+			Fonts
+	****************************************************************/
+
+	/*
+	Hex digit sprites, kept in the reserved memory below 0x200 where FX29 and FX30 point I at them. The small font
+	is 5 rows of 4 pixels per digit, the big one (SUPER-CHIP's, extended to A-F) 10 rows of 8
+	*/
+	static const uint16_t FontAddress = 0x050;
+	static const uint16_t FontStride = 5;
+	static const uint16_t BigFontAddress = 0x0A0;
+	static const uint16_t BigFontStride = 10;
+
+	extern const uint8_t smallFont[0x10 * FontStride];
+	extern const uint8_t bigFont[0x10 * BigFontStride];
+
+}
@@ -0,0 +1,191 @@
+#include "Framebuffer.hpp"
+#include "SpriteBlit.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+using namespace chp8;
+
+/****************************************************************
+			Framebuffer Class Static Defs
+****************************************************************/
+
+const Framebuffer::VideoMode Framebuffer::_64x32 = { 64, 32 };
+const Framebuffer::VideoMode Framebuffer::_64x48 = { 64, 48 };
+const Framebuffer::VideoMode Framebuffer::_64x64 = { 64, 64 };
+const Framebuffer::VideoMode Framebuffer::_128x64 = { 128, 64 };
+
+/****************************************************************
+			Framebuffer Class
+****************************************************************/
+
+Framebuffer::Framebuffer(Framebuffer::VideoMode vmode) {
+	setVideoMode(vmode);
+}
+
+void Framebuffer::setVideoMode(Framebuffer::VideoMode vmode) {
+	mode = vmode;
+
+	// Create the necessary memory, every supported width is a whole number of words
+	wordsPerRow = (mode.width + 63) / 64;
+	vram.assign(wordsPerRow * mode.height, 0);
+	dirtyRows = ~(uint64_t)0;
+}
+
+Framebuffer::VideoMode Framebuffer::getMode() {
+	return mode;
+}
+
+void Framebuffer::setAllPixels(bool active) {
+	std::fill(vram.begin(), vram.end(), active ? ~(uint64_t)0 : 0);
+	markRowsDirty(0, (unsigned int)mode.height);
+}
+
+void Framebuffer::invertAllPixels() {
+	for (uint64_t& word : vram)
+		word = ~word;
+	markRowsDirty(0, (unsigned int)mode.height);
+}
+
+void Framebuffer::setPixel(unsigned int x, unsigned int y, bool a) {
+	if (x >= mode.width || y >= mode.height) {
+		std::cout << "Framebuffer::setPixel(" << x << "," << y << "," << a << ") out of bounds pixel access" << std::endl;
+		return;
+	}
+	uint64_t& word = vram[y * wordsPerRow + (x >> 6)];
+	uint64_t bit = (uint64_t)1 << (63 - (x & 63));
+	word = a ? (word | bit) : (word & ~bit);
+	markRowsDirty(y, 1);
+}
+
+void Framebuffer::invertPixel(unsigned int x, unsigned int y) {
+	if (x >= mode.width || y >= mode.height) {
+		std::cout << "Framebuffer::invertPixel(" << x << "," << y << ") out of bounds pixel access" << std::endl;
+		return;
+	}
+
+	vram[y * wordsPerRow + (x >> 6)] ^= (uint64_t)1 << (63 - (x & 63));
+	markRowsDirty(y, 1);
+}
+
+bool Framebuffer::getPixel(unsigned int x, unsigned int y) {
+	if (x >= mode.width || y >= mode.height)
+		return false;
+	return (vram[y * wordsPerRow + (x >> 6)] >> (63 - (x & 63))) & 1;
+}
+
+size_t Framebuffer::getWordsPerRow() {
+	return wordsPerRow;
+}
+
+const uint64_t* Framebuffer::getRow(unsigned int y) {
+	return &vram[(y % mode.height) * wordsPerRow];
+}
+
+bool Framebuffer::xorRow(unsigned int x, unsigned int y, uint64_t bits) {
+	if (x >= mode.width || y >= mode.height || bits == 0)
+		return false;
+
+	uint64_t* row = &vram[y * wordsPerRow];
+	size_t word = x >> 6;
+	unsigned int shift = x & 63;
+
+	// The row straddles at most two words, the second only exists if it's still on screen
+	uint64_t first = bits >> shift;
+	uint64_t collided = row[word] & first;
+	row[word] ^= first;
+	if (shift != 0 && word + 1 < wordsPerRow) {
+		uint64_t second = bits << (64 - shift);
+		collided |= row[word + 1] & second;
+		row[word + 1] ^= second;
+	}
+
+	markRowsDirty(y, 1);
+	return collided != 0;
+}
+
+bool Framebuffer::xorSprite(unsigned int x, unsigned int y, const uint64_t* rows, unsigned int count) {
+	markRowsDirty(y, count);
+	return blitSprite(vram.data(), wordsPerRow, (unsigned int)mode.width, (unsigned int)mode.height, x, y, rows, count);
+}
+
+bool Framebuffer::xorSpriteWrapped(unsigned int x, unsigned int y, const uint64_t* rows, unsigned int count) {
+	// A sprite is at most 16 pixels square and smaller than the screen, so it splits into up to four clipped pieces
+	// that don't overlap: as drawn, the rows that carry on at the top, and both of those shifted round to the left
+	if (count > MaxSpriteRows)
+		count = MaxSpriteRows;
+	unsigned int below = y + count > mode.height ? y + count - (unsigned int)mode.height : 0;
+	unsigned int fits = count - below;
+
+	bool collided = xorSprite(x, y, rows, fits);
+	if (below > 0)
+		collided |= xorSprite(x, 0, rows + fits, below);
+
+	if (x + 16 > mode.width) {
+		uint64_t wrapped[MaxSpriteRows];
+		unsigned int shift = (unsigned int)mode.width - x;
+		for (unsigned int i = 0; i < count; i++)
+			wrapped[i] = rows[i] << shift;
+		collided |= xorSprite(0, y, wrapped, fits);
+		if (below > 0)
+			collided |= xorSprite(0, 0, wrapped + fits, below);
+	}
+	return collided;
+}
+
+uint64_t Framebuffer::takeDirtyRows() {
+	uint64_t rows = dirtyRows;
+	dirtyRows = 0;
+	if (mode.height < 64)
+		rows &= ((uint64_t)1 << mode.height) - 1;
+	return rows;
+}
+
+const uint64_t* Framebuffer::getWords() {
+	return vram.data();
+}
+
+size_t Framebuffer::getWordCount() {
+	return vram.size();
+}
+
+bool Framebuffer::setWords(Framebuffer::VideoMode vmode, const uint64_t* words, size_t count) {
+	if (vmode.width == 0 || vmode.width % 64 != 0 || vmode.height == 0 || vmode.height > 64 || count != (vmode.width + 63) / 64 * vmode.height)
+		return false;
+
+	// A mode change marks every row, otherwise only the rows that differ
+	if (vmode.width != mode.width || vmode.height != mode.height)
+		setVideoMode(vmode);
+	for (unsigned int y = 0; y < mode.height; y++) {
+		uint64_t* row = &vram[y * wordsPerRow];
+		if (!std::equal(row, row + wordsPerRow, words + y * wordsPerRow)) {
+			std::copy(words + y * wordsPerRow, words + (y + 1) * wordsPerRow, row);
+			markRowsDirty(y, 1);
+		}
+	}
+	return true;
+}
+
+uint64_t Framebuffer::hash() {
+	uint64_t h = 0xCBF29CE484222325ull;
+	auto mix = [&h](uint64_t word) {
+		for (int i = 0; i < 8; i++) {
+			h ^= (word >> (i * 8)) & 0xFF;
+			h *= 0x100000001B3ull;
+		}
+	};
+
+	mix(mode.width);
+	mix(mode.height);
+	for (uint64_t word : vram) {
+		mix(word);
+	}
+	return h;
+}
+
+void Framebuffer::markRowsDirty(unsigned int y, unsigned int count) {
+	if (y >= 64 || count == 0)
+		return;
+	uint64_t rows = count >= 64 ? ~(uint64_t)0 : (((uint64_t)1 << count) - 1);
+	dirtyRows |= rows << y;
+}
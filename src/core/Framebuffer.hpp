@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace chp8 {
+
+	/****************************************************************
+			Framebuffer Class
+	****************************************************************/
+
+	/*
+	Monochrome video memory. Each row is packed into 64-bit words, most significant bit leftmost, so the pixel at x
+	is bit (63 - x % 64) of word x / 64. Displays observe it through getRow() and takeDirtyRows()
+	*/
+	class Framebuffer {
+
+	public:
+		typedef struct {
+			size_t width;
+			size_t height;
+		} VideoMode;
+		static const VideoMode _64x32;
+		static const VideoMode _64x48;
+		static const VideoMode _64x64;
+		static const VideoMode _128x64;
+
+		Framebuffer(Framebuffer::VideoMode vmode = Framebuffer::_64x32);
+
+		void setVideoMode(Framebuffer::VideoMode vmode);
+		Framebuffer::VideoMode getMode();
+
+		void setAllPixels(bool active);
+		void invertAllPixels();
+		void setPixel(unsigned int x, unsigned int y, bool a);
+		void invertPixel(unsigned int x, unsigned int y);
+		bool getPixel(unsigned int x, unsigned int y);
+
+		/*
+		Word level access
+		*/
+		size_t getWordsPerRow();
+		const uint64_t* getRow(unsigned int y);
+
+		/*
+		Bulk access to all of VRAM, rows one after another, for save states. setWords() switches to vmode and
+		copies in count words, which must be exactly what vmode holds, marking only the rows that change. Returns
+		false (and changes nothing) otherwise
+		*/
+		const uint64_t* getWords();
+		size_t getWordCount();
+		bool setWords(Framebuffer::VideoMode vmode, const uint64_t* words, size_t count);
+
+		/*
+		XORs a sprite row into VRAM. bits is left aligned, bit 63 lands on x, and anything past the right edge is
+		clipped. Returns true if any pixel that was on got turned off
+		*/
+		bool xorRow(unsigned int x, unsigned int y, uint64_t bits);
+
+		/*
+		XORs up to 16 left aligned rows starting at (x, y), clipped at the right and bottom edges, and reports any
+		collision the same way
+		*/
+		bool xorSprite(unsigned int x, unsigned int y, const uint64_t* rows, unsigned int count);
+
+		/*
+		As xorSprite(), but wrapping instead of clipping: rows past the bottom carry on at the top and pixels past the
+		right edge at the left
+		*/
+		bool xorSpriteWrapped(unsigned int x, unsigned int y, const uint64_t* rows, unsigned int count);
+
+		/*
+		Returns the rows changed since the last call (bit y for row y, every mode is at most 64 rows tall) and
+		clears them. A mode change marks every row
+		*/
+		uint64_t takeDirtyRows();
+
+		/*
+		64-bit FNV-1a over the mode and every VRAM word. Equal screens hash equal whatever the display does with them
+		*/
+		uint64_t hash();
+
+	private:
+		VideoMode mode;
+		std::vector<uint64_t> vram; // Packed rows of wordsPerRow words
+		size_t wordsPerRow = 1;
+
+		uint64_t dirtyRows = ~(uint64_t)0;
+		void markRowsDirty(unsigned int y, unsigned int count);
+
+	};
+
+}
@@ -0,0 +1,121 @@
+#include "InputLog.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace chp8;
+
+const char InputLog::Magic[8] = { 'C', 'H', 'P', '8', 'R', 'P', 'L', '\0' };
+
+/****************************************************************
+			InputLog Class
+****************************************************************/
+
+void InputLog::begin(uint32_t runSeed, uint32_t runCpuHz, QuirkProfile runProfile) {
+	seed = runSeed;
+	cpuHz = runCpuHz;
+	quirkProfile = runProfile;
+	events.clear();
+	frameHashes.clear();
+}
+
+void InputLog::recordKeys(uint64_t cycle, uint16_t keys) {
+	// Several changes before the same instruction only need the last
+	if (!events.empty() && events.back().cycle == cycle) {
+		events.back().keys = keys;
+		return;
+	}
+
+	Event event = {};
+	event.cycle = cycle;
+	event.keys = keys;
+	events.push_back(event);
+}
+
+void InputLog::recordFrame(uint64_t hash) {
+	frameHashes.push_back(hash);
+}
+
+bool InputLog::save(const std::string& path) {
+	std::ofstream out(path, std::ios::binary);
+	if (!out) {
+		std::cout << "InputLog::save(" << path << ") failed to create the file" << std::endl;
+		return false;
+	}
+
+	FileHeader header = {};
+	std::memcpy(header.magic, Magic, sizeof(header.magic));
+	header.version = Version;
+	header.seed = seed;
+	header.cpuHz = cpuHz;
+	header.quirkProfile = (uint32_t)quirkProfile;
+	header.eventSize = sizeof(Event);
+	header.eventCount = events.size();
+	header.frameCount = frameHashes.size();
+	out.write((const char*)&header, sizeof(header));
+	out.write((const char*)events.data(), events.size() * sizeof(Event));
+	out.write((const char*)frameHashes.data(), frameHashes.size() * sizeof(uint64_t));
+	return (bool)out;
+}
+
+bool InputLog::load(const std::string& path) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in) {
+		std::cout << "InputLog::load(" << path << ") failed to open the file" << std::endl;
+		return false;
+	}
+
+	FileHeader header;
+	if (!in.read((char*)&header, sizeof(header)) || std::memcmp(header.magic, Magic, sizeof(header.magic)) != 0) {
+		std::cout << "InputLog::load(" << path << ") not a CHP-8 input log" << std::endl;
+		return false;
+	}
+	if (header.version != Version || header.eventSize != sizeof(Event)) {
+		std::cout << "InputLog::load(" << path << ") unsupported input log version " << header.version << std::endl;
+		return false;
+	}
+	if (header.quirkProfile > XoChip) {
+		std::cout << "InputLog::load(" << path << ") unknown quirk profile " << header.quirkProfile << std::endl;
+		return false;
+	}
+
+	// Sizes come from the file, so check them against what's actually there before trusting them
+	in.seekg(0, std::ios::end);
+	uint64_t remaining = (uint64_t)in.tellg() - sizeof(header);
+	in.seekg(sizeof(header), std::ios::beg);
+	if (header.eventCount > remaining / sizeof(Event)
+		|| header.frameCount != (remaining - header.eventCount * sizeof(Event)) / sizeof(uint64_t)) {
+		std::cout << "InputLog::load(" << path << ") input log is truncated" << std::endl;
+		return false;
+	}
+
+	seed = header.seed;
+	cpuHz = header.cpuHz;
+	quirkProfile = (QuirkProfile)header.quirkProfile;
+	events.resize((size_t)header.eventCount);
+	frameHashes.resize((size_t)header.frameCount);
+	in.read((char*)events.data(), events.size() * sizeof(Event));
+	in.read((char*)frameHashes.data(), frameHashes.size() * sizeof(uint64_t));
+	return (bool)in;
+}
+
+uint32_t InputLog::getSeed() {
+	return seed;
+}
+
+uint32_t InputLog::getCpuFrequency() {
+	return cpuHz;
+}
+
+QuirkProfile InputLog::getQuirkProfile() {
+	return quirkProfile;
+}
+
+const std::vector<InputLog::Event>& InputLog::getEvents() {
+	return events;
+}
+
+const std::vector<uint64_t>& InputLog::getFrameHashes() {
+	return frameHashes;
+}
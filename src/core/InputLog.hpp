@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Quirks.hpp"
+
+namespace chp8 {
+
+	/****************************************************************
+			InputLog Class
+	****************************************************************/
+
+	/*
+	Everything needed to play a run again exactly: the RNG seed, the CPU frequency, the quirk profile, every keypad
+	change keyed by the instruction it took effect before, and the framebuffer hash after every frame so playback
+	can tell where it first went differently. Timers step once per frame and frames are a fixed number of
+	instructions, so given the same ROM those are the only inputs a run has. Scheduler records into it and plays it
+	back
+	*/
+	class InputLog {
+
+	public:
+		struct Event {
+			uint64_t cycle; // Instructions run before the change
+			uint16_t keys;
+		};
+
+		/*
+		File layout: a FileHeader, eventCount Events, then frameCount 64-bit frame hashes
+		*/
+		struct FileHeader {
+			char magic[8];
+			uint32_t version;
+			uint32_t seed;
+			uint32_t cpuHz; // 0 for a run timed by vipCycleCosts, see Scheduler::setCycleCosts()
+			uint32_t quirkProfile; // QuirkProfile
+			uint32_t reserved; // Zero
+			uint32_t eventSize;
+			uint64_t eventCount;
+			uint64_t frameCount;
+		};
+		static const char Magic[8];
+		static const uint32_t Version = 2; // 1 had no quirk profile and is rejected
+
+		void begin(uint32_t seed, uint32_t cpuHz, QuirkProfile profile); // Clears the log for a new run
+		void recordKeys(uint64_t cycle, uint16_t keys);
+		void recordFrame(uint64_t hash);
+
+		bool save(const std::string& path);
+		bool load(const std::string& path);
+
+		uint32_t getSeed();
+		uint32_t getCpuFrequency();
+		QuirkProfile getQuirkProfile();
+		const std::vector<Event>& getEvents();
+		const std::vector<uint64_t>& getFrameHashes();
+
+	private:
+		uint32_t seed = 0;
+		uint32_t cpuHz = 0;
+		QuirkProfile quirkProfile = Cosmac;
+		std::vector<Event> events;
+		std::vector<uint64_t> frameHashes;
+
+	};
+
+}
@@ -0,0 +1,86 @@
+#include "Instruction.hpp"
+
+using namespace chp8;
+
+/****************************************************************
+			Instruction Decoding
+****************************************************************/
+
+Instruction chp8::decode(uint16_t opcode) {
+	Instruction in;
+	in.opcode = opcode;
+	in.nnn = opcode & 0x0FFF;
+	in.x = (opcode & 0x0F00) >> 8;
+	in.y = (opcode & 0x00F0) >> 4;
+	in.n = opcode & 0x000F;
+	in.kk = opcode & 0x00FF;
+	in.op = OpUnknown;
+
+	// Do a top level decision on the first hex digit, then on whichever digits select the variant
+	switch ((opcode & 0xF000) >> 12) {
+	case 0x0:
+		if (in.nnn == 0x0E0) in.op = Op00E0;
+		else if (in.nnn == 0x0EE) in.op = Op00EE;
+		break;
+
+	case 0x1: in.op = Op1NNN; break;
+	case 0x2: in.op = Op2NNN; break;
+	case 0x3: in.op = Op3XKK; break;
+	case 0x4: in.op = Op4XKK; break;
+	case 0x5: in.op = Op5XY0; break;
+	case 0x6: in.op = Op6XKK; break;
+	case 0x7: in.op = Op7XKK; break;
+
+	case 0x8:
+		switch (in.n) {
+		case 0x0: in.op = Op8XY0; break;
+		case 0x1: in.op = Op8XY1; break;
+		case 0x2: in.op = Op8XY2; break;
+		case 0x3: in.op = Op8XY3; break;
+		case 0x4: in.op = Op8XY4; break;
+		case 0x5: in.op = Op8XY5; break;
+		case 0x6: in.op = Op8XY6; break;
+		case 0x7: in.op = Op8XY7; break;
+		case 0xE: in.op = Op8XYE; break;
+		}
+		break;
+
+	case 0x9: in.op = Op9XY0; break;
+	case 0xA: in.op = OpANNN; break;
+	case 0xB: in.op = OpBNNN; break;
+	case 0xC: in.op = OpCXKK; break;
+	case 0xD: in.op = OpDXYN; break;
+
+	case 0xE:
+		if (in.kk == 0x9E) in.op = OpEX9E;
+		else if (in.kk == 0xA1) in.op = OpEXA1;
+		break;
+
+	case 0xF:
+		switch (in.kk) {
+		case 0x07: in.op = OpFX07; break;
+		case 0x0A: in.op = OpFX0A; break;
+		case 0x15: in.op = OpFX15; break;
+		case 0x18: in.op = OpFX18; break;
+		case 0x1E: in.op = OpFX1E; break;
+		case 0x29: in.op = OpFX29; break;
+		case 0x30: in.op = OpFX30; break;
+		case 0x33: in.op = OpFX33; break;
+		case 0x55: in.op = OpFX55; break;
+		case 0x65: in.op = OpFX65; break;
+		}
+		break;
+	}
+
+	return in;
+}
+
+const char* chp8::operationName(Operation op) {
+	static const char* const names[OpCount] = {
+		"00E0", "00EE", "1NNN", "2NNN", "3XKK", "4XKK", "5XY0", "6XKK", "7XKK",
+		"8XY0", "8XY1", "8XY2", "8XY3", "8XY4", "8XY5", "8XY6", "8XY7", "8XYE",
+		"9XY0", "ANNN", "BNNN", "CXKK", "DXYN", "EX9E", "EXA1",
+		"FX07", "FX0A", "FX15", "FX18", "FX1E", "FX29", "FX30", "FX33", "FX55", "FX65", "????"
+	};
+	return op < OpCount ? names[op] : "????";
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+namespace chp8 {
+
+	/****************************************************************
+			Instruction Decoding
+	****************************************************************/
+
+	/*
+	Identifies the leaf operation of a decoded instruction. Anything that needs to know what an instruction does (the
+	interpreter handlers, the threaded engine's label table, the recompiler) is indexed by this
+	*/
+	enum Operation : uint8_t {
+		Op00E0, Op00EE, Op1NNN, Op2NNN, Op3XKK, Op4XKK, Op5XY0, Op6XKK, Op7XKK,
+		Op8XY0, Op8XY1, Op8XY2, Op8XY3, Op8XY4, Op8XY5, Op8XY6, Op8XY7, Op8XYE,
+		Op9XY0, OpANNN, OpBNNN, OpCXKK, OpDXYN, OpEX9E, OpEXA1,
+		OpFX07, OpFX0A, OpFX15, OpFX18, OpFX1E, OpFX29, OpFX30, OpFX33, OpFX55, OpFX65, OpUnknown,
+		OpCount
+	};
+
+	/*
+	A fully decoded instruction, operands are extracted once so executing it needs no further masking or switching
+	*/
+	struct Instruction {
+		uint16_t opcode = 0;
+		Operation op = OpUnknown;
+		uint16_t nnn = 0; // Lowest 12 bits, address operand
+		uint8_t x = 0; // Second hex digit, register operand
+		uint8_t y = 0; // Third hex digit, register operand
+		uint8_t n = 0; // Lowest 4 bits
+		uint8_t kk = 0; // Lowest 8 bits, byte operand
+	};
+
+	Instruction decode(uint16_t opcode);
+	const char* operationName(Operation op); // Opcode pattern, e.g. "8XY4"
+
+}
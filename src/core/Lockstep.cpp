@@ -0,0 +1,907 @@
+#include "Lockstep.hpp"
+
+#include <cstring>
+
+#include "Font.hpp"
+#include "Operations.hpp"
+#include "Random.hpp"
+#include "SpriteBlit.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CHP8_LANES_X86 1
+#define CHP8_TARGET_AVX2 __attribute__((target("avx2")))
+#define CHP8_TARGET_AVX512 __attribute__((target("avx512bw")))
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CHP8_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define CHP8_INLINE __forceinline
+#else
+#define CHP8_INLINE inline
+#endif
+
+using namespace chp8;
+
+/****************************************************************
+			Lane Kernels
+****************************************************************/
+
+/*
+Register instructions across a row of lanes. Each kernel works through the row a LaneBlock at a time, copying the
+operands into locals first: rows x, y and F may be the same row, and the copies are what let the compiler treat
+them as independent and vectorize the loops. Everything here is force inlined into the per-ISA entry points at
+the bottom, so each of those gets its own vector width
+*/
+namespace {
+
+	const size_t B = Lockstep::LaneBlock;
+
+	CHP8_INLINE uint8_t blend(uint8_t mask, uint8_t a, uint8_t b) {
+		return (a & mask) | (b & ~mask);
+	}
+
+	/*
+	Each operation computes the new Vx, and VF where WritesF, from Vx (a), Vy (b) and kk. Quirks pick between
+	instantiations once per group step, never per lane
+	*/
+	struct Op6 { static const bool WritesF = false; static CHP8_INLINE void apply(uint8_t a, uint8_t b, uint8_t kk, uint8_t& x, uint8_t& f) { x = kk; } };
+	struct Op7 { static const bool WritesF = false; static CHP8_INLINE void apply(uint8_t a, uint8_t b, uint8_t kk, uint8_t& x, uint8_t& f) { x = a + kk; } };
+	struct Op80 { static const bool WritesF = false; static CHP8_INLINE void apply(uint8_t a, uint8_t b, uint8_t kk, uint8_t& x, uint8_t& f) { x = b; } };
+	template <bool ResetsF> struct Op81 { static const bool WritesF = ResetsF; static CHP8_INLINE void apply(uint8_t a, uint8_t b, uint8_t kk, uint8_t& x, uint8_t& f) { f = 0; x = a | b; } };
+	template <bool ResetsF> struct Op82 { static const bool WritesF = ResetsF; static CHP8_INLINE void apply(uint8_t a, uint8_t b, uint8_t kk, uint8_t& x, uint8_t& f) { f = 0; x = a & b; } };
+	template <bool ResetsF> struct Op83 { static const bool WritesF = ResetsF; static CHP8_INLINE void apply(uint8_t a, uint8_t b, uint8_t kk, uint8_t& x, uint8_t& f) { f = 0; x = a ^ b; } };
+	struct Op84 { static const bool WritesF = true; static CHP8_INLINE void apply(uint8_t a, uint8_t b, uint8_t kk, uint8_t& x, uint8_t& f) { x = a + b; f = x < a; } };
+	struct Op85 { static const bool WritesF = true; static CHP8_INLINE void apply(uint8_t a, uint8_t b, uint8_t kk, uint8_t& x, uint8_t& f) { f = a > b; x = a - b; } };
+	template <bool FromVy> struct Op86 { static const bool WritesF = true; static CHP8_INLINE void apply(uint8_t a, uint8_t b, uint8_t kk, uint8_t& x, uint8_t& f) { uint8_t s = FromVy ? b : a; f = s & 1; x = s >> 1; } };
+	struct Op87 { static const bool WritesF = true; static CHP8_INLINE void apply(uint8_t a, uint8_t b, uint8_t kk, uint8_t& x, uint8_t& f) { f = b > a; x = b - a; } };
+	template <bool FromVy> struct Op8E { static const bool WritesF = true; static CHP8_INLINE void apply(uint8_t a, uint8_t b, uint8_t kk, uint8_t& x, uint8_t& f) { uint8_t s = FromVy ? b : a; f = s >> 7; x = s << 1; } };
+
+	template <typename Op> CHP8_INLINE void aluRows(uint8_t* vx, const uint8_t* vy, uint8_t* vf, uint8_t kk, const uint8_t* mask, size_t begin, size_t end) {
+		for (size_t base = begin; base < end; base += B) {
+			uint8_t a[B], b[B], m[B], f[B], x[B], nf[B];
+			std::memcpy(a, vx + base, B);
+			std::memcpy(b, vy + base, B);
+			std::memcpy(m, mask + base, B);
+			if (Op::WritesF)
+				std::memcpy(f, vf + base, B);
+
+			for (size_t i = 0; i < B; i++) {
+				uint8_t rx = 0, rf = 0;
+				Op::apply(a[i], b[i], kk, rx, rf);
+				x[i] = blend(m[i], rx, a[i]);
+				nf[i] = blend(m[i], rf, Op::WritesF ? f[i] : 0);
+			}
+
+			// VF first, so that when x is F the result wins, as in ops::
+			if (Op::WritesF)
+				std::memcpy(vf + base, nf, B);
+			std::memcpy(vx + base, x, B);
+		}
+	}
+
+	CHP8_INLINE void aluBody(const Instruction& in, const Quirks& quirks, uint8_t* v, uint16_t* i, const uint8_t* mask, size_t lanes, size_t begin, size_t end) {
+		uint8_t* vx = v + in.x * lanes;
+		const uint8_t* vy = v + in.y * lanes;
+		uint8_t* vf = v + 0xF * lanes;
+
+		switch (in.op) {
+		case Op6XKK: aluRows<Op6>(vx, vy, vf, in.kk, mask, begin, end); break;
+		case Op7XKK: aluRows<Op7>(vx, vy, vf, in.kk, mask, begin, end); break;
+		case Op8XY0: aluRows<Op80>(vx, vy, vf, 0, mask, begin, end); break;
+		case Op8XY1:
+			if (quirks.logicResetsVF) aluRows<Op81<true>>(vx, vy, vf, 0, mask, begin, end);
+			else aluRows<Op81<false>>(vx, vy, vf, 0, mask, begin, end);
+			break;
+		case Op8XY2:
+			if (quirks.logicResetsVF) aluRows<Op82<true>>(vx, vy, vf, 0, mask, begin, end);
+			else aluRows<Op82<false>>(vx, vy, vf, 0, mask, begin, end);
+			break;
+		case Op8XY3:
+			if (quirks.logicResetsVF) aluRows<Op83<true>>(vx, vy, vf, 0, mask, begin, end);
+			else aluRows<Op83<false>>(vx, vy, vf, 0, mask, begin, end);
+			break;
+		case Op8XY4: aluRows<Op84>(vx, vy, vf, 0, mask, begin, end); break;
+		case Op8XY5: aluRows<Op85>(vx, vy, vf, 0, mask, begin, end); break;
+		case Op8XY6:
+			if (quirks.shiftReadsVy) aluRows<Op86<true>>(vx, vy, vf, 0, mask, begin, end);
+			else aluRows<Op86<false>>(vx, vy, vf, 0, mask, begin, end);
+			break;
+		case Op8XY7: aluRows<Op87>(vx, vy, vf, 0, mask, begin, end); break;
+		case Op8XYE:
+			if (quirks.shiftReadsVy) aluRows<Op8E<true>>(vx, vy, vf, 0, mask, begin, end);
+			else aluRows<Op8E<false>>(vx, vy, vf, 0, mask, begin, end);
+			break;
+
+		case OpANNN:
+			for (size_t l = begin; l < end; l++) {
+				i[l] = mask[l] ? in.nnn : i[l];
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	/*
+	Skips write 0xFF into taken for every lane in the group whose condition holds and return how many did
+	*/
+	template <bool Equal, bool Immediate> CHP8_INLINE uint32_t skipRows(const uint8_t* vx, const uint8_t* vy, uint8_t kk, const uint8_t* mask, uint8_t* taken, size_t begin, size_t end) {
+		uint32_t count = 0;
+		for (size_t base = begin; base < end; base += B) {
+			uint8_t a[B], b[B], m[B], t[B];
+			std::memcpy(a, vx + base, B);
+			std::memcpy(m, mask + base, B);
+			if (!Immediate)
+				std::memcpy(b, vy + base, B);
+
+			for (size_t i = 0; i < B; i++) {
+				bool equal = a[i] == (Immediate ? kk : b[i]);
+				t[i] = (equal == Equal ? 0xFF : 0) & m[i];
+				count += t[i] & 1;
+			}
+			std::memcpy(taken + base, t, B);
+		}
+		return count;
+	}
+
+	template <bool Held> CHP8_INLINE uint32_t keyRows(const uint8_t* vx, const uint16_t* keys, const uint8_t* mask, uint8_t* taken, size_t begin, size_t end) {
+		uint32_t count = 0;
+		for (size_t base = begin; base < end; base += B) {
+			uint8_t a[B], m[B], t[B];
+			uint16_t k[B];
+			std::memcpy(a, vx + base, B);
+			std::memcpy(m, mask + base, B);
+			std::memcpy(k, keys + base, sizeof(k));
+
+			for (size_t i = 0; i < B; i++) {
+				bool held = (k[i] >> (a[i] & 0xF)) & 1;
+				t[i] = (held == Held ? 0xFF : 0) & m[i];
+				count += t[i] & 1;
+			}
+			std::memcpy(taken + base, t, B);
+		}
+		return count;
+	}
+
+	CHP8_INLINE uint32_t skipBody(const Instruction& in, const uint8_t* v, const uint16_t* keys, const uint8_t* mask, uint8_t* taken, size_t lanes, size_t begin, size_t end) {
+		const uint8_t* vx = v + in.x * lanes;
+		const uint8_t* vy = v + in.y * lanes;
+
+		switch (in.op) {
+		case Op3XKK: return skipRows<true, true>(vx, vy, in.kk, mask, taken, begin, end);
+		case Op4XKK: return skipRows<false, true>(vx, vy, in.kk, mask, taken, begin, end);
+		case Op5XY0: return skipRows<true, false>(vx, vy, 0, mask, taken, begin, end);
+		case Op9XY0: return skipRows<false, false>(vx, vy, 0, mask, taken, begin, end);
+		case OpEX9E: return keyRows<true>(vx, keys, mask, taken, begin, end);
+		case OpEXA1: return keyRows<false>(vx, keys, mask, taken, begin, end);
+		default: return 0;
+		}
+	}
+
+	/*
+	Group bookkeeping, in the same block form so it vectorizes as well. Lanes flagged 0xFF in leaving leave the group
+	for destination, are charged stepsRun instructions and are marked parked if parkFlag is 0xFF. Returns how many left
+	*/
+	CHP8_INLINE uint32_t leaveBody(uint8_t* mask, uint8_t* parked, const uint8_t* leaving, uint16_t* pc, uint32_t* remaining,
+		uint16_t destination, uint32_t stepsRun, uint8_t parkFlag, size_t begin, size_t end) {
+		uint32_t count = 0;
+		for (size_t base = begin; base < end; base += B) {
+			uint8_t t[B], m[B], p[B];
+			uint16_t c[B];
+			uint32_t r[B];
+			std::memcpy(t, leaving + base, B);
+			std::memcpy(m, mask + base, B);
+			std::memcpy(p, parked + base, B);
+			std::memcpy(c, pc + base, sizeof(c));
+			std::memcpy(r, remaining + base, sizeof(r));
+
+			for (size_t i = 0; i < B; i++) {
+				m[i] &= ~t[i];
+				p[i] |= t[i] & parkFlag;
+				c[i] = t[i] ? destination : c[i];
+				r[i] -= t[i] ? stepsRun : 0;
+				count += t[i] & 1;
+			}
+
+			std::memcpy(mask + base, m, B);
+			std::memcpy(parked + base, p, B);
+			std::memcpy(pc + base, c, sizeof(c));
+			std::memcpy(remaining + base, r, sizeof(r));
+		}
+		return count;
+	}
+
+	/*
+	Parked lanes at groupPC rejoin, credited the stepsRun instructions they sat out. Returns how many did
+	*/
+	CHP8_INLINE uint32_t rejoinBody(uint8_t* mask, uint8_t* parked, const uint16_t* pc, uint32_t* remaining,
+		uint16_t groupPC, uint32_t stepsRun, size_t begin, size_t end) {
+		uint32_t count = 0;
+		for (size_t base = begin; base < end; base += B) {
+			uint8_t m[B], p[B];
+			uint16_t c[B];
+			uint32_t r[B];
+			std::memcpy(m, mask + base, B);
+			std::memcpy(p, parked + base, B);
+			std::memcpy(c, pc + base, sizeof(c));
+			std::memcpy(r, remaining + base, sizeof(r));
+
+			for (size_t i = 0; i < B; i++) {
+				uint8_t joining = p[i] & (c[i] == groupPC ? 0xFF : 0);
+				m[i] |= joining;
+				p[i] &= ~joining;
+				r[i] += joining ? stepsRun : 0;
+				count += joining & 1;
+			}
+
+			std::memcpy(mask + base, m, B);
+			std::memcpy(parked + base, p, B);
+			std::memcpy(remaining + base, r, sizeof(r));
+		}
+		return count;
+	}
+
+	/*
+	The lowest PC in the group, and the lanes (flagged in differing) that aren't there
+	*/
+	CHP8_INLINE uint16_t lowestBody(const uint8_t* mask, const uint16_t* pc, size_t begin, size_t end) {
+		uint16_t lowest = 0xFFFF;
+		for (size_t base = begin; base < end; base += B) {
+			uint8_t m[B];
+			uint16_t c[B];
+			std::memcpy(m, mask + base, B);
+			std::memcpy(c, pc + base, sizeof(c));
+
+			for (size_t i = 0; i < B; i++) {
+				uint16_t candidate = m[i] ? c[i] : 0xFFFF;
+				lowest = candidate < lowest ? candidate : lowest;
+			}
+		}
+		return lowest;
+	}
+
+	CHP8_INLINE uint32_t differBody(const uint8_t* mask, const uint16_t* pc, uint16_t value, uint8_t* differing, size_t begin, size_t end) {
+		uint32_t count = 0;
+		for (size_t base = begin; base < end; base += B) {
+			uint8_t m[B], d[B];
+			uint16_t c[B];
+			std::memcpy(m, mask + base, B);
+			std::memcpy(c, pc + base, sizeof(c));
+
+			for (size_t i = 0; i < B; i++) {
+				d[i] = m[i] & (c[i] != value ? 0xFF : 0);
+				count += d[i] & 1;
+			}
+			std::memcpy(differing + base, d, B);
+		}
+		return count;
+	}
+
+	/*
+	Calls and returns. Lanes that run in step almost always share a stack depth, so each block checks that first and
+	then pushes or pops a whole stack row at once; otherwise it goes lane by lane. Lanes whose stack over or
+	underflows are flagged in failed and left untouched. Returns how many failed
+	*/
+	CHP8_INLINE bool sharedDepth(const uint8_t* m, const uint8_t* s, uint8_t& depth) {
+		uint8_t lo = 0xFF, hi = 0;
+		for (size_t i = 0; i < B; i++) {
+			uint8_t a = m[i] ? s[i] : 0xFF;
+			uint8_t b = m[i] ? s[i] : 0;
+			lo = a < lo ? a : lo;
+			hi = b > hi ? b : hi;
+		}
+		depth = lo;
+		return lo == hi;
+	}
+
+	CHP8_INLINE uint32_t callBody(const uint8_t* mask, uint8_t* sp, uint16_t* stack, uint8_t* failed, size_t lanes,
+		uint16_t returnPC, size_t begin, size_t end) {
+		uint32_t count = 0;
+		for (size_t base = begin; base < end; base += B) {
+			uint8_t m[B], s[B], f[B] = {};
+			std::memcpy(m, mask + base, B);
+			std::memcpy(s, sp + base, B);
+
+			uint8_t depth;
+			if (sharedDepth(m, s, depth) && depth <= 0xF) {
+				uint16_t row[B];
+				std::memcpy(row, stack + depth * lanes + base, sizeof(row));
+				for (size_t i = 0; i < B; i++) {
+					row[i] = m[i] ? returnPC : row[i];
+					s[i] += m[i] & 1;
+				}
+				std::memcpy(stack + depth * lanes + base, row, sizeof(row));
+			}
+			else {
+				for (size_t i = 0; i < B; i++) {
+					if (!m[i])
+						continue;
+					if (s[i] > 0xF) {
+						f[i] = 0xFF;
+						count++;
+						continue;
+					}
+					stack[s[i] * lanes + base + i] = returnPC;
+					s[i]++;
+				}
+			}
+
+			std::memcpy(sp + base, s, B);
+			std::memcpy(failed + base, f, B);
+		}
+		return count;
+	}
+
+	CHP8_INLINE uint32_t returnBody(const uint8_t* mask, uint8_t* sp, const uint16_t* stack, uint16_t* pc, uint8_t* failed,
+		size_t lanes, size_t begin, size_t end) {
+		uint32_t count = 0;
+		for (size_t base = begin; base < end; base += B) {
+			uint8_t m[B], s[B], f[B] = {};
+			uint16_t c[B];
+			std::memcpy(m, mask + base, B);
+			std::memcpy(s, sp + base, B);
+			std::memcpy(c, pc + base, sizeof(c));
+
+			uint8_t depth;
+			if (sharedDepth(m, s, depth) && depth != 0 && depth <= 0x10) {
+				uint16_t row[B];
+				std::memcpy(row, stack + (depth - 1) * lanes + base, sizeof(row));
+				for (size_t i = 0; i < B; i++) {
+					c[i] = m[i] ? row[i] + 2 : c[i];
+					s[i] -= m[i] & 1;
+				}
+			}
+			else {
+				for (size_t i = 0; i < B; i++) {
+					if (!m[i])
+						continue;
+					if (s[i] == 0) {
+						f[i] = 0xFF;
+						count++;
+						continue;
+					}
+					s[i]--;
+					c[i] = stack[s[i] * lanes + base + i] + 2;
+				}
+			}
+
+			std::memcpy(sp + base, s, B);
+			std::memcpy(pc + base, c, sizeof(c));
+			std::memcpy(failed + base, f, B);
+		}
+		return count;
+	}
+
+	/*
+	One set of entry points per instruction set, each with the bodies above inlined into it
+	*/
+#define CHP8_LANE_KERNELS(suffix, attributes) \
+	attributes void alu##suffix(const Instruction& in, const Quirks& quirks, uint8_t* v, uint16_t* i, const uint8_t* mask, size_t lanes, size_t begin, size_t end) { \
+		aluBody(in, quirks, v, i, mask, lanes, begin, end); } \
+	attributes uint32_t skip##suffix(const Instruction& in, const uint8_t* v, const uint16_t* keys, const uint8_t* mask, uint8_t* taken, size_t lanes, size_t begin, size_t end) { \
+		return skipBody(in, v, keys, mask, taken, lanes, begin, end); } \
+	attributes uint32_t leave##suffix(uint8_t* mask, uint8_t* parked, const uint8_t* leaving, uint16_t* pc, uint32_t* remaining, uint16_t destination, uint32_t stepsRun, uint8_t parkFlag, size_t begin, size_t end) { \
+		return leaveBody(mask, parked, leaving, pc, remaining, destination, stepsRun, parkFlag, begin, end); } \
+	attributes uint32_t rejoin##suffix(uint8_t* mask, uint8_t* parked, const uint16_t* pc, uint32_t* remaining, uint16_t groupPC, uint32_t stepsRun, size_t begin, size_t end) { \
+		return rejoinBody(mask, parked, pc, remaining, groupPC, stepsRun, begin, end); } \
+	attributes uint16_t lowest##suffix(const uint8_t* mask, const uint16_t* pc, size_t begin, size_t end) { \
+		return lowestBody(mask, pc, begin, end); } \
+	attributes uint32_t differ##suffix(const uint8_t* mask, const uint16_t* pc, uint16_t value, uint8_t* differing, size_t begin, size_t end) { \
+		return differBody(mask, pc, value, differing, begin, end); } \
+	attributes uint32_t call##suffix(const uint8_t* mask, uint8_t* sp, uint16_t* stack, uint8_t* failed, size_t lanes, uint16_t returnPC, size_t begin, size_t end) { \
+		return callBody(mask, sp, stack, failed, lanes, returnPC, begin, end); } \
+	attributes uint32_t return##suffix(const uint8_t* mask, uint8_t* sp, const uint16_t* stack, uint16_t* pc, uint8_t* failed, size_t lanes, size_t begin, size_t end) { \
+		return returnBody(mask, sp, stack, pc, failed, lanes, begin, end); }
+
+#define CHP8_LANE_KERNEL_TABLE(suffix) \
+	{ &alu##suffix, &skip##suffix, &leave##suffix, &rejoin##suffix, &lowest##suffix, &differ##suffix, &call##suffix, &return##suffix }
+
+	struct LaneKernels {
+		void (*alu)(const Instruction& in, const Quirks& quirks, uint8_t* v, uint16_t* i, const uint8_t* mask, size_t lanes, size_t begin, size_t end);
+		uint32_t (*skip)(const Instruction& in, const uint8_t* v, const uint16_t* keys, const uint8_t* mask, uint8_t* taken, size_t lanes, size_t begin, size_t end);
+		uint32_t (*leave)(uint8_t* mask, uint8_t* parked, const uint8_t* leaving, uint16_t* pc, uint32_t* remaining, uint16_t destination, uint32_t stepsRun, uint8_t parkFlag, size_t begin, size_t end);
+		uint32_t (*rejoin)(uint8_t* mask, uint8_t* parked, const uint16_t* pc, uint32_t* remaining, uint16_t groupPC, uint32_t stepsRun, size_t begin, size_t end);
+		uint16_t (*lowest)(const uint8_t* mask, const uint16_t* pc, size_t begin, size_t end);
+		uint32_t (*differ)(const uint8_t* mask, const uint16_t* pc, uint16_t value, uint8_t* differing, size_t begin, size_t end);
+		uint32_t (*call)(const uint8_t* mask, uint8_t* sp, uint16_t* stack, uint8_t* failed, size_t lanes, uint16_t returnPC, size_t begin, size_t end);
+		uint32_t (*ret)(const uint8_t* mask, uint8_t* sp, const uint16_t* stack, uint16_t* pc, uint8_t* failed, size_t lanes, size_t begin, size_t end);
+	};
+
+	CHP8_LANE_KERNELS(Default, )
+#if defined(CHP8_LANES_X86)
+	CHP8_LANE_KERNELS(AVX2, CHP8_TARGET_AVX2)
+	CHP8_LANE_KERNELS(AVX512, CHP8_TARGET_AVX512)
+
+	bool hasAVX512BW() {
+		return __builtin_cpu_supports("avx512bw");
+	}
+#endif
+
+	LaneKernels selectLaneKernels() {
+#if defined(CHP8_LANES_X86)
+		if (hasAVX512BW())
+			return CHP8_LANE_KERNEL_TABLE(AVX512);
+		if (hasAVX2())
+			return CHP8_LANE_KERNEL_TABLE(AVX2);
+#endif
+		return CHP8_LANE_KERNEL_TABLE(Default);
+	}
+
+	const LaneKernels laneKernels = selectLaneKernels();
+
+}
+
+/****************************************************************
+			Lockstep Class
+****************************************************************/
+
+Lockstep::Lockstep(size_t n) {
+	laneCount = n;
+	lanes = (n + LaneBlock - 1) / LaneBlock * LaneBlock;
+
+	v.resize(0x10 * lanes);
+	r_I.resize(lanes);
+	pc.resize(lanes);
+	sp.resize(lanes);
+	stack.resize(0x10 * lanes);
+	r_sound.resize(lanes);
+	r_delay.resize(lanes);
+	keys.resize(lanes);
+	rng.resize(lanes);
+	error.resize(lanes);
+	framebuffers.resize(laneCount);
+	laneMemory.resize(laneCount);
+
+	remaining.resize(lanes);
+	mask.resize(lanes);
+	taken.resize(lanes);
+	parked.resize(lanes);
+	pcCounts.resize(0x10000);
+
+	reset();
+}
+
+void Lockstep::reset() {
+	std::fill(v.begin(), v.end(), 0);
+	std::fill(r_I.begin(), r_I.end(), 0);
+	std::fill(pc.begin(), pc.end(), 0);
+	std::fill(sp.begin(), sp.end(), 0);
+	std::fill(stack.begin(), stack.end(), 0);
+	std::fill(r_sound.begin(), r_sound.end(), 0);
+	std::fill(r_delay.begin(), r_delay.end(), 0);
+	std::fill(keys.begin(), keys.end(), 0);
+	std::fill(error.begin(), error.end(), (uint8_t)Chip8::None);
+	std::fill(remaining.begin(), remaining.end(), 0);
+	std::fill(mask.begin(), mask.end(), 0);
+	std::fill(parked.begin(), parked.end(), 0);
+	for (size_t l = 0; l < lanes; l++) {
+		setSeed(l, DefaultRandomSeed + (uint32_t)l); // Lane 0 matches a Chip8 that was never seeded
+	}
+	for (Framebuffer& framebuffer : framebuffers) {
+		framebuffer.setVideoMode(Framebuffer::_128x64); // Same as Chip8
+	}
+
+	std::memset(memory, 0, sizeof(memory));
+	std::memcpy(memory + FontAddress, smallFont, sizeof(smallFont)); // As Chip8::loadFonts()
+	std::memcpy(memory + BigFontAddress, bigFont, sizeof(bigFont));
+	for (std::vector<uint8_t>& lane : laneMemory) {
+		lane.clear();
+	}
+	privateLanes = 0;
+	groupSteps = 0;
+}
+
+void Lockstep::loadProgram(const uint8_t* program, size_t size, uint16_t address) {
+	for (size_t i = 0; i < size && address + i < sizeof(memory); i++) {
+		memory[address + i] = program[i];
+		for (std::vector<uint8_t>& lane : laneMemory) {
+			if (!lane.empty())
+				lane[address + i] = program[i];
+		}
+	}
+	std::fill(pc.begin(), pc.end(), address);
+}
+
+uint64_t Lockstep::execute(uint32_t count) {
+	for (size_t l = 0; l < laneCount; l++) {
+		remaining[l] = error[l] == Chip8::None ? count : 0;
+	}
+
+	uint16_t groupPC;
+	uint32_t steps;
+	while (formGroup(groupPC, steps)) {
+		runGroup(groupPC, steps);
+	}
+
+	uint64_t total = 0;
+	for (size_t l = 0; l < laneCount; l++) {
+		// Lanes that errored stopped early, remaining was zeroed when they did
+		total += count - remaining[l];
+	}
+	return total;
+}
+
+/****************************************************************
+			Lockstep Class : Accessors
+****************************************************************/
+
+void Lockstep::setKeys(size_t lane, uint16_t state) {
+	keys[lane] = state;
+}
+
+void Lockstep::setSeed(size_t lane, uint32_t seed) {
+	rng[lane] = seedRandom(seed);
+}
+
+void Lockstep::setQuirks(const Quirks& q) {
+	quirks = q;
+}
+
+size_t Lockstep::getLaneCount() {
+	return laneCount;
+}
+
+uint8_t Lockstep::getRegister(size_t lane, uint8_t index) {
+	return v[(index & 0xF) * lanes + lane];
+}
+
+uint16_t Lockstep::getI(size_t lane) {
+	return r_I[lane];
+}
+
+uint16_t Lockstep::getPC(size_t lane) {
+	return pc[lane];
+}
+
+uint8_t Lockstep::getSP(size_t lane) {
+	return sp[lane];
+}
+
+uint8_t Lockstep::getSoundTimer(size_t lane) {
+	return r_sound[lane];
+}
+
+uint8_t Lockstep::getDelayTimer(size_t lane) {
+	return r_delay[lane];
+}
+
+Chip8::Chip8Error Lockstep::getError(size_t lane) {
+	return (Chip8::Chip8Error)error[lane];
+}
+
+Framebuffer& Lockstep::getFramebuffer(size_t lane) {
+	return framebuffers[lane];
+}
+
+uint64_t Lockstep::getGroupSteps() {
+	return groupSteps;
+}
+
+/****************************************************************
+			Lockstep Class : Scheduling
+****************************************************************/
+
+uint8_t Lockstep::read(size_t lane, uint32_t address) {
+	// Addresses wrap, like Memory::read()
+	const uint8_t* bytes = laneMemory[lane].empty() ? memory : laneMemory[lane].data();
+	return bytes[address & (MemorySize - 1)];
+}
+
+uint8_t* Lockstep::writableMemory(size_t lane) {
+	if (laneMemory[lane].empty()) {
+		laneMemory[lane].assign(memory, memory + MemorySize);
+		privateLanes++;
+	}
+	return laneMemory[lane].data();
+}
+
+uint16_t Lockstep::fetchGroup(uint16_t groupPC, uint32_t stepsRun) {
+	if (privateLanes == 0)
+		return (memory[groupPC & (MemorySize - 1)] << 8) | memory[(groupPC + 1) & (MemorySize - 1)];
+
+	// The first lane in the group decides, any lane whose memory holds something else there goes its own way
+	size_t lead = groupBegin;
+	while (!mask[lead])
+		lead++;
+	uint16_t opcode = (read(lead, groupPC) << 8) | read(lead, groupPC + 1);
+	for (size_t l = lead + 1; l < groupEnd; l++) {
+		if (mask[l] && ((read(l, groupPC) << 8) | read(l, groupPC + 1)) != opcode)
+			leaveGroup(l, groupPC, stepsRun);
+	}
+	return opcode;
+}
+
+bool Lockstep::formGroup(uint16_t& groupPC, uint32_t& steps) {
+	// Find the most common PC among lanes with instructions left
+	uint32_t best = 0;
+	for (size_t l = 0; l < laneCount; l++) {
+		if (remaining[l] == 0)
+			continue;
+		uint32_t n = ++pcCounts[pc[l]];
+		if (n > best) {
+			best = n;
+			groupPC = pc[l];
+		}
+	}
+	if (best == 0)
+		return false;
+
+	// Gather its lanes, running the group no further than its shortest budget, and clear the histogram
+	steps = RegroupInterval;
+	groupSize = 0;
+	size_t first = laneCount, last = 0;
+	for (size_t l = 0; l < laneCount; l++) {
+		mask[l] = 0;
+		if (remaining[l] == 0)
+			continue;
+		pcCounts[pc[l]] = 0;
+		if (pc[l] != groupPC)
+			continue;
+
+		mask[l] = 0xFF;
+		groupSize++;
+		if (remaining[l] < steps)
+			steps = remaining[l];
+		if (first == laneCount)
+			first = l;
+		last = l;
+	}
+
+	// The kernels only look at the blocks the group spans
+	groupBegin = first / LaneBlock * LaneBlock;
+	groupEnd = (last / LaneBlock + 1) * LaneBlock;
+	return true;
+}
+
+void Lockstep::leaveGroup(size_t lane, uint16_t lanePC, uint32_t stepsRun) {
+	mask[lane] = 0;
+	groupSize--;
+	pc[lane] = lanePC;
+	remaining[lane] = error[lane] != Chip8::None ? 0 : remaining[lane] - stepsRun;
+}
+
+bool Lockstep::watchParkedPC(uint16_t address) {
+	int p = 0;
+	while (p < parkedCount && parkedPCs[p] != address)
+		p++;
+	if (p == MaxParkedPCs)
+		return false; // Too many places to watch, lanes there wait for the next regrouping
+	parkedPCs[p] = address;
+	if (p == parkedCount)
+		parkedCount++;
+	return true;
+}
+
+void Lockstep::rejoinGroup(uint16_t groupPC, uint32_t stepsRun) {
+	int p = 0;
+	while (p < parkedCount && parkedPCs[p] != groupPC)
+		p++;
+	if (p == parkedCount)
+		return;
+	parkedPCs[p] = parkedPCs[--parkedCount];
+
+	groupSize += laneKernels.rejoin(mask.data(), parked.data(), pc.data(), remaining.data(), groupPC, stepsRun, groupBegin, groupEnd);
+}
+
+void Lockstep::failLanes(Chip8::Chip8Error e, uint16_t lanePC, uint32_t stepsRun) {
+	for (size_t l = groupBegin; l < groupEnd; l++) {
+		if (taken[l]) {
+			error[l] = e;
+			leaveGroup(l, lanePC, stepsRun);
+		}
+	}
+}
+
+uint16_t Lockstep::followLowestPC(uint32_t stepsRun) {
+	// After lanes set their own PCs, the group carries on from the lowest, for the same reason it keeps the lanes
+	// that don't skip, and parks the rest where they are
+	uint16_t next = laneKernels.lowest(mask.data(), pc.data(), groupBegin, groupEnd);
+	if (laneKernels.differ(mask.data(), pc.data(), next, taken.data(), groupBegin, groupEnd) == 0)
+		return next;
+
+	for (size_t l = groupBegin; l < groupEnd; l++) {
+		if (!taken[l])
+			continue;
+		parked[l] = watchParkedPC(pc[l]) ? 0xFF : 0;
+		leaveGroup(l, pc[l], stepsRun);
+	}
+	return next;
+}
+
+void Lockstep::runGroup(uint16_t groupPC, uint32_t steps) {
+	// Lanes in the group don't track their own PC, it is written back when they leave
+	uint32_t step = 0;
+	parkedCount = 0;
+	while (step < steps && groupSize > 0) {
+		// Lanes that branched away earlier come back once the group reaches them
+		if (parkedCount > 0)
+			rejoinGroup(groupPC, step);
+
+		Instruction in = decode(fetchGroup(groupPC, step));
+		step++;
+		groupSteps++;
+
+		switch (in.op) {
+		case Op6XKK: case Op7XKK:
+		case Op8XY0: case Op8XY1: case Op8XY2: case Op8XY3: case Op8XY4:
+		case Op8XY5: case Op8XY6: case Op8XY7: case Op8XYE:
+		case OpANNN:
+			laneKernels.alu(in, quirks, v.data(), r_I.data(), mask.data(), lanes, groupBegin, groupEnd);
+			groupPC += 2;
+			break;
+
+		case Op1NNN:
+			groupPC = in.nnn;
+			break;
+
+		case Op3XKK: case Op4XKK: case Op5XY0: case Op9XY0:
+		case OpEX9E: case OpEXA1: {
+			uint32_t skipping = laneKernels.skip(in, v.data(), keys.data(), mask.data(), taken.data(), lanes, groupBegin, groupEnd);
+			if (skipping == 0 || skipping == groupSize) {
+				groupPC += skipping == 0 ? 2 : 4;
+				break;
+			}
+
+			// Divergence. The lanes that don't skip stay in the group, which usually brings it straight to where the
+			// others are parked
+			uint8_t parkFlag = watchParkedPC(groupPC + 4) ? 0xFF : 0;
+			groupSize -= laneKernels.leave(mask.data(), parked.data(), taken.data(), pc.data(), remaining.data(),
+				groupPC + 4, step, parkFlag, groupBegin, groupEnd);
+			groupPC += 2;
+			break;
+		}
+
+		case Op2NNN:
+			if (laneKernels.call(mask.data(), sp.data(), stack.data(), taken.data(), lanes, groupPC, groupBegin, groupEnd) != 0)
+				failLanes(Chip8::StackOverflow, groupPC + 2, step);
+			groupPC = in.nnn;
+			break;
+
+		case Op00EE:
+			if (laneKernels.ret(mask.data(), sp.data(), stack.data(), pc.data(), taken.data(), lanes, groupBegin, groupEnd) != 0)
+				failLanes(Chip8::StackUnderflow, groupPC + 2, step);
+			groupPC = followLowestPC(step);
+			break;
+
+		default:
+			// Everything else runs lane by lane
+			for (size_t l = groupBegin; l < groupEnd; l++) {
+				if (!mask[l])
+					continue;
+				pc[l] = groupPC;
+				executeLane(l, in);
+				if (error[l] != Chip8::None)
+					leaveGroup(l, pc[l], step);
+			}
+			groupPC = followLowestPC(step);
+			break;
+		}
+	}
+
+	// Write back the PC and budget of whoever stayed to the end
+	groupSize -= laneKernels.leave(mask.data(), parked.data(), mask.data(), pc.data(), remaining.data(),
+		groupPC, step, 0, groupBegin, groupEnd);
+	std::fill(parked.begin() + groupBegin, parked.begin() + groupEnd, 0);
+}
+
+/****************************************************************
+			Lockstep Class : Lane Instructions
+****************************************************************/
+
+void Lockstep::executeLane(size_t lane, const Instruction& in) {
+	uint8_t& vx = v[in.x * lanes + lane];
+	uint8_t& vy = v[in.y * lanes + lane];
+	uint8_t& vf = v[0xF * lanes + lane];
+
+	switch (in.op) {
+	// Calls, returns and everything the group runs as vector operations never get here
+	case Op00E0:
+		framebuffers[lane].setAllPixels(false);
+		break;
+
+	case OpBNNN:
+		pc[lane] = (quirks.jumpAddsVx ? vx : v[lane]) + in.nnn - 2;
+		break;
+
+	case OpCXKK:
+		vx = nextRandomByte(rng[lane]) & in.kk;
+		break;
+
+	case OpDXYN: {
+		// As Chip8::executeDXYN()
+		bool large = in.n == 0;
+		unsigned int count = large ? 16 : in.n;
+		uint16_t i = r_I[lane];
+		uint64_t rows[16];
+		for (unsigned int row = 0; row < count; row++) {
+			if (large)
+				rows[row] = (uint64_t)((read(lane, i + row * 2) << 8) | read(lane, i + row * 2 + 1)) << 48;
+			else
+				rows[row] = (uint64_t)read(lane, i + row) << 56;
+		}
+
+		Framebuffer& framebuffer = framebuffers[lane];
+		Framebuffer::VideoMode mode = framebuffer.getMode();
+		unsigned int x = vx % mode.width;
+		unsigned int y = vy % mode.height;
+		if (quirks.spritesWrap)
+			vf = framebuffer.xorSpriteWrapped(x, y, rows, count) ? 1 : 0;
+		else
+			vf = framebuffer.xorSprite(x, y, rows, count) ? 1 : 0;
+		break;
+	}
+
+	// As Chip8::executeFX07() to executeFX65()
+	case OpFX07:
+		vx = r_delay[lane];
+		break;
+
+	case OpFX0A: {
+		uint16_t held = keys[lane];
+		if (held == 0) {
+			pc[lane] -= 2;
+			break;
+		}
+		uint8_t key = 0;
+		while (((held >> key) & 1) == 0)
+			key++;
+		vx = key;
+		break;
+	}
+
+	case OpFX15:
+		r_delay[lane] = vx;
+		break;
+
+	case OpFX18:
+		r_sound[lane] = vx;
+		break;
+
+	case OpFX1E:
+		r_I[lane] += vx;
+		break;
+
+	case OpFX29:
+		r_I[lane] = FontAddress + (vx & 0xF) * FontStride;
+		break;
+
+	case OpFX30:
+		r_I[lane] = BigFontAddress + (vx & 0xF) * BigFontStride;
+		break;
+
+	case OpFX33: {
+		uint8_t digits[3];
+		ops::decimalDigits(vx, digits);
+		uint8_t* bytes = writableMemory(lane);
+		for (uint32_t d = 0; d < 3; d++)
+			bytes[(r_I[lane] + d) & (MemorySize - 1)] = digits[d];
+		break;
+	}
+
+	case OpFX55: case OpFX65: {
+		// Registers are stored by row, so lane by lane this is a gather or scatter rather than a copy
+		uint8_t* bytes = in.op == OpFX55 ? writableMemory(lane) : nullptr;
+		for (uint32_t x = 0; x <= in.x; x++) {
+			uint32_t address = (r_I[lane] + x) & (MemorySize - 1);
+			if (bytes != nullptr)
+				bytes[address] = v[x * lanes + lane];
+			else
+				v[x * lanes + lane] = read(lane, address);
+		}
+		if (quirks.loadStoreIncrementsI)
+			r_I[lane] += in.x + 1;
+		break;
+	}
+
+	case OpUnknown:
+		error[lane] = Chip8::UnknownOpcode;
+		break;
+
+	default:
+		break;
+	}
+
+	pc[lane] += 2;
+}
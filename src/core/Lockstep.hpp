@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "CHP-8.hpp"
+#include "Framebuffer.hpp"
+#include "Instruction.hpp"
+#include "Quirks.hpp"
+
+namespace chp8 {
+
+	/****************************************************************
+			Lockstep Class
+	****************************************************************/
+
+	/*
+	Runs many instances of one program side by side, each lane with its own registers, stack, keypad, RNG and
+	framebuffer. Register state is stored structure-of-arrays, register x of every lane in one contiguous row, so
+	lanes that share a PC execute each register instruction as a handful of vector byte operations across the
+	whole row, with inactive lanes masked off.
+
+	A group is formed from the lanes at the most common PC and runs until it has done RegroupInterval steps. Lanes
+	that branch away from the group (a skip going the other way, a return to a different address) are parked where
+	they are and rejoin if the group reaches that address, which after a skip is usually the next instruction.
+	Anything still apart waits for the next regrouping. A lane stops at its first error. Otherwise lanes follow
+	Chip8 exactly, lane n drawing the same random numbers as a Chip8 seeded with n + 1.
+
+	Memory is one shared image until a lane writes to it (FX33, FX55), which gives that lane a private copy. Once
+	any lane has one, a group checks each step that its lanes still hold the same instruction at the group PC and
+	leaves behind any that don't
+	*/
+	class Lockstep {
+
+	public:
+		static const size_t LaneBlock = 64; // The lane count is rounded up to a multiple of this
+		static const int RegroupInterval = 256; // Steps a group runs before lanes are regrouped
+		static const int MaxParkedPCs = 8; // Addresses a group watches for lanes to rejoin
+
+		Lockstep(size_t lanes);
+
+		void reset();
+		void loadProgram(const uint8_t* program, size_t size, uint16_t address = 0x200);
+
+		/*
+		Runs every lane that hasn't errored for count instructions. Returns the total instructions run across lanes
+		*/
+		uint64_t execute(uint32_t count);
+
+		/*
+		Per lane input
+		*/
+		void setKeys(size_t lane, uint16_t state);
+		void setSeed(size_t lane, uint32_t seed); // CXKK draws from a per lane xorshift generator
+		void setQuirks(const Quirks& q); // The same for every lane. Chip8::getQuirks() gives a profile's
+
+		/*
+		Per lane state
+		*/
+		size_t getLaneCount();
+		uint8_t getRegister(size_t lane, uint8_t index);
+		uint16_t getI(size_t lane);
+		uint16_t getPC(size_t lane);
+		uint8_t getSP(size_t lane);
+		uint8_t getSoundTimer(size_t lane);
+		uint8_t getDelayTimer(size_t lane);
+		Chip8::Chip8Error getError(size_t lane);
+		Framebuffer& getFramebuffer(size_t lane);
+
+		/*
+		Instructions issued to groups, however many lanes each ran on. Lane instructions over this is the average
+		group width
+		*/
+		uint64_t getGroupSteps();
+
+	private:
+		size_t laneCount; // Lanes in use
+		size_t lanes; // Row length, laneCount rounded up to LaneBlock
+
+		/*
+		Structure-of-arrays state, element [row * lanes + lane]
+		*/
+		std::vector<uint8_t> v; // 16 rows
+		std::vector<uint16_t> r_I;
+		std::vector<uint16_t> pc;
+		std::vector<uint8_t> sp;
+		std::vector<uint16_t> stack; // 16 rows
+		std::vector<uint8_t> r_sound;
+		std::vector<uint8_t> r_delay;
+		std::vector<uint16_t> keys;
+		std::vector<uint32_t> rng;
+		std::vector<uint8_t> error;
+		std::vector<Framebuffer> framebuffers;
+
+		static const uint32_t MemorySize = 0x1000;
+		uint8_t memory[MemorySize]{};
+		std::vector<std::vector<uint8_t>> laneMemory; // Empty until the lane first writes
+		size_t privateLanes = 0; // Lanes with their own memory
+		Quirks quirks;
+
+		/*
+		Scheduling
+		*/
+		std::vector<uint32_t> remaining; // Instructions left in this execute() for each lane
+		std::vector<uint8_t> mask; // 0xFF for lanes in the current group
+		std::vector<uint8_t> taken; // Per lane results of the last skip, failed call or divergence
+		std::vector<uint32_t> pcCounts; // Histogram used while regrouping, all zero between uses
+		std::vector<uint8_t> parked; // Lanes that left the current group and may rejoin it
+		uint16_t parkedPCs[MaxParkedPCs]{};
+		int parkedCount = 0;
+		size_t groupSize = 0;
+		size_t groupBegin = 0; // The group's lanes all lie in [groupBegin, groupEnd), a whole number of blocks
+		size_t groupEnd = 0;
+		uint64_t groupSteps = 0;
+
+		uint8_t read(size_t lane, uint32_t address);
+		uint8_t* writableMemory(size_t lane);
+		uint16_t fetchGroup(uint16_t groupPC, uint32_t stepsRun);
+		bool formGroup(uint16_t& groupPC, uint32_t& steps);
+		void runGroup(uint16_t groupPC, uint32_t steps);
+		void leaveGroup(size_t lane, uint16_t lanePC, uint32_t stepsRun);
+		bool watchParkedPC(uint16_t address);
+		void rejoinGroup(uint16_t groupPC, uint32_t stepsRun);
+		void failLanes(Chip8::Chip8Error e, uint16_t lanePC, uint32_t stepsRun); // Lanes flagged in taken
+		uint16_t followLowestPC(uint32_t stepsRun);
+
+		void executeLane(size_t lane, const Instruction& in);
+
+	};
+
+}
@@ -0,0 +1,22 @@
+#include "Memory.hpp"
+
+#include <iostream>
+
+using namespace mem;
+
+/****************************************************************
+			Memory Class
+****************************************************************/
+
+#if defined(CHP8_MEMORY_CHECKS)
+void mem::reportOutOfBounds(uint32_t index, uint8_t value, bool write, uint32_t size) {
+	std::cout << "Memory::" << (write ? "write(" : "read(") << index;
+	if (write)
+		std::cout << "," << (unsigned int)value;
+	std::cout << ") out of bounds exception (size = " << size << ")" << std::endl;
+}
+
+void mem::reportWatchpoint(uint32_t index, uint8_t value, bool write) {
+	std::cout << "Memory watchpoint: " << (write ? "write " : "read ") << std::hex << index << " = " << (unsigned int)value << std::dec << std::endl;
+}
+#endif
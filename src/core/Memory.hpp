@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+namespace mem {
+
+	/*
+	Out of line reporting for the checked build, kept out of the accessors
+	*/
+#if defined(CHP8_MEMORY_CHECKS)
+	void reportOutOfBounds(uint32_t index, uint8_t value, bool write, uint32_t size);
+	void reportWatchpoint(uint32_t index, uint8_t value, bool write);
+#endif
+
+	/****************************************************************
+			Memory Class
+	****************************************************************/
+
+	/*
+	Size bytes held inline, cache line aligned. Size is a power of two (Chip8 uses 4KB under every profile) and
+	addresses are masked into it, so out of range accesses wrap around instead of branching. Building with
+	CHP8_MEMORY_CHECKS swaps the masking for strict bounds checks that report and ignore the access, and adds
+	watchpoints
+	*/
+	template <uint32_t Size> class Memory {
+
+		static_assert(Size != 0 && (Size & (Size - 1)) == 0, "Memory size must be a power of two");
+
+	public:
+		static const uint32_t AddressMask = Size - 1;
+
+		/*
+		Called with the range of every write, so owners can drop anything derived from those bytes
+		*/
+		typedef std::function<void(uint32_t index, uint32_t length)> WriteObserver;
+
+		inline uint8_t read(uint32_t index) {
+#if defined(CHP8_MEMORY_CHECKS)
+			if (index >= Size) {
+				reportOutOfBounds(index, 0, false, Size);
+				return 0;
+			}
+			watch(index, data[index], false);
+			return data[index];
+#else
+			return data[index & AddressMask];
+#endif
+		}
+
+		inline int8_t readSigned(uint32_t index) {
+			return (int8_t)read(index);
+		}
+
+		inline bool write(uint32_t index, uint8_t value) {
+#if defined(CHP8_MEMORY_CHECKS)
+			if (index >= Size) {
+				reportOutOfBounds(index, value, true, Size);
+				return false;
+			}
+			watch(index, value, true);
+#else
+			index &= AddressMask;
+#endif
+			data[index] = value;
+			if (writeObserver)
+				writeObserver(index, 1);
+			return true;
+		}
+
+		/*
+		Bulk transfers of up to Size bytes, as one copy and one observer call. In the masked build a range that runs
+		past the end wraps to the start, like the same bytes done one at a time
+		*/
+		inline bool readBlock(uint32_t index, uint8_t* out, uint32_t length) {
+#if defined(CHP8_MEMORY_CHECKS)
+			if (index >= Size || length > Size - index) {
+				reportOutOfBounds(index, 0, false, Size);
+				std::memset(out, 0, length);
+				return false;
+			}
+			for (uint32_t i = 0; i < length; i++)
+				watch(index + i, data[index + i], false);
+#else
+			index &= AddressMask;
+			if (length > Size - index) {
+				uint32_t first = Size - index;
+				std::memcpy(out, &data[index], first);
+				std::memcpy(out + first, data, length - first);
+				return true;
+			}
+#endif
+			std::memcpy(out, &data[index], length);
+			return true;
+		}
+
+		inline bool writeBlock(uint32_t index, const uint8_t* values, uint32_t length) {
+#if defined(CHP8_MEMORY_CHECKS)
+			if (index >= Size || length > Size - index) {
+				reportOutOfBounds(index, length != 0 ? values[0] : 0, true, Size);
+				return false;
+			}
+			for (uint32_t i = 0; i < length; i++)
+				watch(index + i, values[i], true);
+#else
+			index &= AddressMask;
+			if (length > Size - index) {
+				uint32_t first = Size - index;
+				return writeBlock(index, values, first) && writeBlock(0, values + first, length - first);
+			}
+#endif
+			std::memcpy(&data[index], values, length);
+			if (writeObserver)
+				writeObserver(index, length);
+			return true;
+		}
+
+		/*
+		Zeroes every byte without notifying the write observer
+		*/
+		void clear() {
+			std::memset(data, 0, Size);
+		}
+
+		/*
+		Direct read access to length bytes starting at index, or nullptr if any of them are out of bounds. Never
+		wraps, callers that need the wrapped bytes go through read()
+		*/
+		inline const uint8_t* getSpan(uint32_t index, uint32_t length) {
+			if (index >= Size || length > Size - index)
+				return nullptr;
+			return &data[index];
+		}
+
+		void setWriteObserver(WriteObserver observer) {
+			writeObserver = observer;
+		}
+
+		/*
+		Watchpoints, only built with CHP8_MEMORY_CHECKS. The handler runs before every read or write of a watched byte,
+		with the value read or about to be written. Without a handler hits are printed
+		*/
+#if defined(CHP8_MEMORY_CHECKS)
+		enum Access { Read = 1, Write = 2, ReadWrite = 3 };
+		typedef std::function<void(uint32_t index, uint8_t value, bool write)> WatchHandler;
+
+		void addWatchpoint(uint32_t first, uint32_t last, Access access) {
+			watchpoints.push_back(Watchpoint{ first, last, access });
+		}
+
+		void clearWatchpoints() {
+			watchpoints.clear();
+		}
+
+		void setWatchHandler(WatchHandler handler) {
+			watchHandler = handler;
+		}
+#endif
+
+	private:
+		alignas(64) uint8_t data[Size]{};
+
+		WriteObserver writeObserver;
+
+#if defined(CHP8_MEMORY_CHECKS)
+		struct Watchpoint {
+			uint32_t first;
+			uint32_t last; // Inclusive
+			Access access;
+		};
+		std::vector<Watchpoint> watchpoints;
+		WatchHandler watchHandler;
+
+		void watch(uint32_t index, uint8_t value, bool write) {
+			for (const Watchpoint& w : watchpoints) {
+				if (index < w.first || index > w.last || !(w.access & (write ? Write : Read)))
+					continue;
+				if (watchHandler)
+					watchHandler(index, value, write);
+				else
+					reportWatchpoint(index, value, write);
+			}
+		}
+#endif
+
+	};
+}
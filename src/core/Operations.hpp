@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Font.hpp"
+
+namespace chp8 {
+
+	/****************************************************************
+			Register Operations
+	****************************************************************/
+
+	/*
+	Semantics of the instructions that only read and write V and I. The interpreter handlers call these, and so does
+	the code the static recompiler generates, so with constant operands they fold down to a few host instructions.
+	Where an instruction writes VF and Vx, the order is significant when x or y is F. The instructions that differ
+	between interpreters take the quirk profile (see Quirks.hpp) as a template argument
+	*/
+	namespace ops {
+
+		inline bool skip3XKK(const uint8_t* v, uint8_t x, uint8_t kk) {
+			// Skip next instruction if Vx == kk, (3xkk)
+			return v[x] == kk;
+		}
+
+		inline bool skip4XKK(const uint8_t* v, uint8_t x, uint8_t kk) {
+			// Skip next instruction if Vx != kk, (4xkk)
+			return v[x] != kk;
+		}
+
+		inline bool skip5XY0(const uint8_t* v, uint8_t x, uint8_t y) {
+			// Skip next instruction if Vx == Vy, (5xy0)
+			return v[x] == v[y];
+		}
+
+		inline bool skip9XY0(const uint8_t* v, uint8_t x, uint8_t y) {
+			// Skip next instruction if Vx != Vy, (9xy0)
+			return v[x] != v[y];
+		}
+
+		inline void execute6XKK(uint8_t* v, uint8_t x, uint8_t kk) {
+			// Set Vx = kk, (6xkk)
+			v[x] = kk;
+		}
+
+		inline void execute7XKK(uint8_t* v, uint8_t x, uint8_t kk) {
+			// Set Vx += kk, (7xkk)
+			v[x] += kk;
+		}
+
+		inline void execute8XY0(uint8_t* v, uint8_t x, uint8_t y) {
+			// Set Vx = Vy, (8xy0)
+			v[x] = v[y];
+		}
+
+		template <typename Q> inline void execute8XY1(uint8_t* v, uint8_t x, uint8_t y) {
+			// Set Vx = (Vx | Vy), (8xy1), clearing VF on the COSMAC VIP
+			uint8_t result = v[x] | v[y];
+			if (Q::logicResetsVF)
+				v[0xF] = 0;
+			v[x] = result;
+		}
+
+		template <typename Q> inline void execute8XY2(uint8_t* v, uint8_t x, uint8_t y) {
+			// Set Vx = (Vx & Vy), (8xy2), clearing VF on the COSMAC VIP
+			uint8_t result = v[x] & v[y];
+			if (Q::logicResetsVF)
+				v[0xF] = 0;
+			v[x] = result;
+		}
+
+		template <typename Q> inline void execute8XY3(uint8_t* v, uint8_t x, uint8_t y) {
+			// Set Vx = (Vx ^ Vy), (8xy3), clearing VF on the COSMAC VIP
+			uint8_t result = v[x] ^ v[y];
+			if (Q::logicResetsVF)
+				v[0xF] = 0;
+			v[x] = result;
+		}
+
+		inline void execute8XY4(uint8_t* v, uint8_t x, uint8_t y) {
+			// Set Vx = Vx + Vy, set VF = carry (if Vx + Vy > 255), (8xy4)
+			uint16_t result = v[x] + v[y];
+			v[0xF] = result > 255 ? 1 : 0;
+			v[x] = (uint8_t)result;
+		}
+
+		inline void execute8XY5(uint8_t* v, uint8_t x, uint8_t y) {
+			// Set Vx = Vx - Vy, set VF = carry (if Vx > Vy), (8xy5)
+			v[0xF] = v[x] > v[y] ? 1 : 0;
+			v[x] = (uint8_t)(v[x] - v[y]);
+		}
+
+		template <typename Q> inline void execute8XY6(uint8_t* v, uint8_t x, uint8_t y) {
+			// Set Vx = Vy >> 1 (or Vx >> 1 in place), set VF to the bit shifted out, (8xy6)
+			uint8_t value = Q::shiftReadsVy ? v[y] : v[x];
+			v[0xF] = value & 0x1;
+			v[x] = value >> 1;
+		}
+
+		inline void execute8XY7(uint8_t* v, uint8_t x, uint8_t y) {
+			// Set Vx = Vy - Vx, set VF = carry (if Vy > Vx), (8xy7)
+			v[0xF] = v[y] > v[x] ? 1 : 0;
+			v[x] = (uint8_t)(v[y] - v[x]);
+		}
+
+		template <typename Q> inline void execute8XYE(uint8_t* v, uint8_t x, uint8_t y) {
+			// Set Vx = Vy << 1 (or Vx << 1 in place), set VF to the bit shifted out, (8xyE)
+			uint8_t value = Q::shiftReadsVy ? v[y] : v[x];
+			v[0xF] = (value & 0x80) >> 7;
+			v[x] = value << 1;
+		}
+
+		inline void executeANNN(uint16_t& i, uint16_t nnn) {
+			// Puts 0NNN into the register I
+			i = nnn;
+		}
+
+		inline void executeFX1E(uint16_t& i, const uint8_t* v, uint8_t x) {
+			// Set I = I + Vx, (Fx1E)
+			i += v[x];
+		}
+
+		inline void executeFX29(uint16_t& i, const uint8_t* v, uint8_t x) {
+			// Set I to the small font sprite for the low digit of Vx, (Fx29)
+			i = FontAddress + (v[x] & 0xF) * FontStride;
+		}
+
+		inline void executeFX30(uint16_t& i, const uint8_t* v, uint8_t x) {
+			// Set I to the big font sprite for the low digit of Vx, (Fx30)
+			i = BigFontAddress + (v[x] & 0xF) * BigFontStride;
+		}
+
+		inline void decimalDigits(uint8_t value, uint8_t* digits) {
+			// Hundreds, tens and ones of a byte for Fx33. Multiplying by 41 / 4096 and 205 / 2048 divides exactly
+			// by 100 and 10 over the range involved, without a division
+			uint32_t hundreds = (value * 41u) >> 12;
+			uint32_t rest = value - hundreds * 100;
+			uint32_t tens = (rest * 205u) >> 11;
+			digits[0] = (uint8_t)hundreds;
+			digits[1] = (uint8_t)tens;
+			digits[2] = (uint8_t)(rest - tens * 10);
+		}
+
+	}
+
+}
@@ -0,0 +1,161 @@
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+using namespace chp8;
+
+/****************************************************************
+			Profiler Class
+****************************************************************/
+
+Profiler::Profiler() {
+	clear();
+}
+
+void Profiler::clear() {
+	std::memset(opCounts, 0, sizeof(opCounts));
+	std::memset(familyCounts, 0, sizeof(familyCounts));
+	std::memset(addressCounts, 0, sizeof(addressCounts));
+	std::memset(addressOpcodes, 0, sizeof(addressOpcodes));
+	nodes.assign(1, Node{ 0, 0, 0, 0 });
+	children.clear();
+	current = 0;
+}
+
+void Profiler::enter(uint16_t address) {
+	address &= AddressCount - 1;
+	uint64_t key = ((uint64_t)current << 16) | address;
+	auto child = children.find(key);
+	if (child == children.end()) {
+		nodes.push_back(Node{ current, address, 0, 0 });
+		child = children.emplace(key, (uint32_t)nodes.size() - 1).first;
+	}
+	current = child->second;
+	nodes[current].calls++;
+}
+
+void Profiler::leave() {
+	// A return with no call seen (the profiler was attached mid call) stays at the top
+	current = nodes[current].parent;
+}
+
+uint64_t Profiler::getInstructionCount() {
+	uint64_t total = 0;
+	for (uint64_t n : opCounts)
+		total += n;
+	return total;
+}
+
+uint64_t Profiler::getOperationCount(Operation op) {
+	return op < OpCount ? opCounts[op] : 0;
+}
+
+uint64_t Profiler::getAddressCount(uint16_t address) {
+	return addressCounts[address & (AddressCount - 1)];
+}
+
+void Profiler::writeReport(std::ostream& out, size_t top) {
+	uint64_t total = getInstructionCount();
+	auto percent = [total](uint64_t n) { return total != 0 ? 100.0 * n / total : 0.0; };
+	char line[128];
+
+	out << "Instructions: " << total << "\n";
+
+	// Operations, then the families (first hex digit of the opcode) they belong to
+	std::vector<int> ops;
+	for (int op = 0; op < OpCount; op++) {
+		if (opCounts[op] != 0)
+			ops.push_back(op);
+	}
+	std::sort(ops.begin(), ops.end(), [this](int a, int b) { return opCounts[a] > opCounts[b]; });
+
+	out << "\nOperations\n";
+	for (int op : ops) {
+		std::snprintf(line, sizeof(line), "  %-8s %14llu %7.2f%%\n", operationName((Operation)op), (unsigned long long)opCounts[op], percent(opCounts[op]));
+		out << line;
+	}
+
+	out << "\nFamilies\n";
+	for (int family = 0; family < 0x10; family++) {
+		if (familyCounts[family] == 0)
+			continue;
+		std::snprintf(line, sizeof(line), "  %Xxxx     %14llu %7.2f%%\n", family, (unsigned long long)familyCounts[family], percent(familyCounts[family]));
+		out << line;
+	}
+
+	// Hottest addresses
+	std::vector<uint16_t> addresses;
+	for (size_t address = 0; address < AddressCount; address++) {
+		if (addressCounts[address] != 0)
+			addresses.push_back((uint16_t)address);
+	}
+	std::sort(addresses.begin(), addresses.end(), [this](uint16_t a, uint16_t b) { return addressCounts[a] > addressCounts[b]; });
+	if (addresses.size() > top)
+		addresses.resize(top);
+
+	out << "\nHot addresses\n";
+	for (uint16_t address : addresses) {
+		Operation op = decode(addressOpcodes[address]).op;
+		std::snprintf(line, sizeof(line), "  %03X  %04X  %-8s %14llu %7.2f%%\n", address, addressOpcodes[address], operationName(op),
+			(unsigned long long)addressCounts[address], percent(addressCounts[address]));
+		out << line;
+	}
+
+	// Subroutines. Self counts what ran in the subroutine itself, total adds everything it called. A recursive
+	// subroutine counts once per stack however often it appears in it
+	std::vector<uint64_t> self(AddressCount, 0), inclusive(AddressCount, 0), calls(AddressCount, 0);
+	std::vector<uint16_t> seen;
+	for (size_t n = 1; n < nodes.size(); n++) {
+		self[nodes[n].address] += nodes[n].count;
+		calls[nodes[n].address] += nodes[n].calls;
+		seen.clear();
+		for (uint32_t up = (uint32_t)n; up != 0; up = nodes[up].parent) {
+			if (std::find(seen.begin(), seen.end(), nodes[up].address) != seen.end())
+				continue;
+			seen.push_back(nodes[up].address);
+			inclusive[nodes[up].address] += nodes[n].count;
+		}
+	}
+
+	std::vector<uint16_t> subroutines;
+	for (size_t address = 0; address < AddressCount; address++) {
+		if (calls[address] != 0)
+			subroutines.push_back((uint16_t)address);
+	}
+	std::sort(subroutines.begin(), subroutines.end(), [&inclusive](uint16_t a, uint16_t b) { return inclusive[a] > inclusive[b]; });
+	if (subroutines.size() > top)
+		subroutines.resize(top);
+
+	out << "\nSubroutines              total               self       calls\n";
+	std::snprintf(line, sizeof(line), "  main     %14llu %7.2f%% %14llu %7.2f%%\n", (unsigned long long)total, percent(total),
+		(unsigned long long)nodes[0].count, percent(nodes[0].count));
+	out << line;
+	for (uint16_t address : subroutines) {
+		std::snprintf(line, sizeof(line), "  sub_%03X  %14llu %7.2f%% %14llu %7.2f%% %10llu\n", address, (unsigned long long)inclusive[address],
+			percent(inclusive[address]), (unsigned long long)self[address], percent(self[address]), (unsigned long long)calls[address]);
+		out << line;
+	}
+}
+
+void Profiler::writeFoldedStacks(std::ostream& out) {
+	for (size_t n = 0; n < nodes.size(); n++) {
+		if (nodes[n].count == 0)
+			continue;
+		writePath(out, (uint32_t)n);
+		out << " " << nodes[n].count << "\n";
+	}
+}
+
+void Profiler::writePath(std::ostream& out, uint32_t node) {
+	if (node == 0) {
+		out << "main";
+		return;
+	}
+
+	writePath(out, nodes[node].parent);
+	char name[16];
+	std::snprintf(name, sizeof(name), ";sub_%03X", nodes[node].address);
+	out << name;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <vector>
+
+#include "Instruction.hpp"
+
+namespace chp8 {
+
+	/****************************************************************
+			Profiler Class
+	****************************************************************/
+
+	/*
+	Counts executed instructions per operation and per address, and attributes each one to the call stack it ran
+	under. Stacks are followed through SP: an instruction that pushed entered a subroutine at the new PC, one that
+	popped left it, so 2NNN, 00EE and any other call like instruction are all seen the same way. Each distinct
+	stack is a node in a tree holding its own count, which is all a hotspot report and a folded stack file (one
+	"main;sub_2A4;sub_310 <count>" line per stack, for flamegraph.pl and friends) need.
+
+	Chip8 only feeds a profiler when built with CHP8_PROFILE defined. Without it there is no setProfiler() and the
+	engines carry no profiling code at all
+	*/
+	class Profiler {
+
+	public:
+		static const size_t AddressCount = 0x1000;
+
+		Profiler();
+
+		void clear();
+
+		/*
+		Emulation thread, once for every instruction executed at address
+		*/
+		inline void count(const Instruction& in, uint16_t address) {
+			opCounts[in.op]++;
+			familyCounts[in.opcode >> 12]++;
+			addressCounts[address & (AddressCount - 1)]++;
+			addressOpcodes[address & (AddressCount - 1)] = in.opcode;
+			nodes[current].count++;
+		}
+		void enter(uint16_t address); // Called into a subroutine at address
+		void leave(); // Returned from the current one
+
+		uint64_t getInstructionCount();
+		uint64_t getOperationCount(Operation op);
+		uint64_t getAddressCount(uint16_t address);
+
+		/*
+		Sorted text report: operations, the top addresses and subroutines by total instructions
+		*/
+		void writeReport(std::ostream& out, size_t top = 20);
+		void writeFoldedStacks(std::ostream& out);
+
+	private:
+		uint64_t opCounts[OpCount];
+		uint64_t familyCounts[0x10];
+		uint64_t addressCounts[AddressCount];
+		uint16_t addressOpcodes[AddressCount]; // The last opcode seen at each address
+
+		/*
+		Call tree. Node 0 is the program outside any subroutine
+		*/
+		struct Node {
+			uint32_t parent;
+			uint16_t address; // Entry point of the subroutine
+			uint64_t count; // Instructions run with exactly this stack
+			uint64_t calls;
+		};
+		std::vector<Node> nodes;
+		std::map<uint64_t, uint32_t> children; // (parent << 16 | address) to node
+		uint32_t current = 0;
+
+		void writePath(std::ostream& out, uint32_t node);
+
+	};
+
+}
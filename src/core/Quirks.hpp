@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string>
+
+namespace chp8 {
+
+	/****************************************************************
+			Quirks
+	****************************************************************/
+
+	/*
+	Behaviours that differ between CHIP-8 interpreters, and that ROMs written for one of them depend on. Each profile
+	is a policy type of compile time constants: Chip8 instantiates its handlers and threaded engine once per
+	profile, so every quirk check folds away and the running engine carries none of them
+	*/
+	struct CosmacQuirks {
+		static const bool shiftReadsVy = true; // 8XY6/8XYE shift Vy into Vx, rather than Vx in place
+		static const bool loadStoreIncrementsI = true; // FX55/FX65 leave I past the last register transferred
+		static const bool jumpAddsVx = false; // BXNN jumps to XNN + Vx, rather than BNNN to NNN + V0
+		static const bool logicResetsVF = true; // 8XY1/8XY2/8XY3 clear VF
+		static const bool spritesWrap = false; // DXYN wraps sprites around the edges, rather than clipping them
+	};
+
+	struct SuperChipQuirks {
+		static const bool shiftReadsVy = false;
+		static const bool loadStoreIncrementsI = false;
+		static const bool jumpAddsVx = true;
+		static const bool logicResetsVF = false;
+		static const bool spritesWrap = false;
+	};
+
+	struct XoChipQuirks {
+		static const bool shiftReadsVy = true;
+		static const bool loadStoreIncrementsI = true;
+		static const bool jumpAddsVx = false;
+		static const bool logicResetsVF = false;
+		static const bool spritesWrap = true;
+	};
+
+	/*
+	The profiles by name, as given in Chip8's conf string: "chip8" (the COSMAC VIP, the default), "schip" and
+	"xochip"
+	*/
+	enum QuirkProfile { Cosmac, SuperChip, XoChip };
+
+	inline bool findQuirkProfile(const std::string& name, QuirkProfile& profile) {
+		if (name == "chip8")
+			profile = Cosmac;
+		else if (name == "schip")
+			profile = SuperChip;
+		else if (name == "xochip")
+			profile = XoChip;
+		else
+			return false;
+		return true;
+	}
+
+	/*
+	The same flags as values, for the code that decides once per block or group rather than per instruction: the
+	recompiler and Lockstep
+	*/
+	struct Quirks {
+		bool shiftReadsVy = CosmacQuirks::shiftReadsVy;
+		bool loadStoreIncrementsI = CosmacQuirks::loadStoreIncrementsI;
+		bool jumpAddsVx = CosmacQuirks::jumpAddsVx;
+		bool logicResetsVF = CosmacQuirks::logicResetsVF;
+		bool spritesWrap = CosmacQuirks::spritesWrap;
+
+		template <typename Profile> static Quirks of() {
+			Quirks q;
+			q.shiftReadsVy = Profile::shiftReadsVy;
+			q.loadStoreIncrementsI = Profile::loadStoreIncrementsI;
+			q.jumpAddsVx = Profile::jumpAddsVx;
+			q.logicResetsVF = Profile::logicResetsVF;
+			q.spritesWrap = Profile::spritesWrap;
+			return q;
+		}
+
+		static Quirks of(QuirkProfile profile) {
+			switch (profile) {
+			case SuperChip: return of<SuperChipQuirks>();
+			case XoChip: return of<XoChipQuirks>();
+			default: return of<CosmacQuirks>();
+			}
+		}
+	};
+
+}
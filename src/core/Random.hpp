@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+namespace chp8 {
+
+	/****************************************************************
+			Random Numbers
+	****************************************************************/
+
+	/*
+	The generator behind CXKK, a 32-bit xorshift. Its whole state is one word, so every instance (or lockstep lane)
+	carries its own, save states capture it and a run is reproducible from its seed
+	*/
+	static const uint32_t DefaultRandomSeed = 1;
+
+	inline uint32_t seedRandom(uint32_t seed) {
+		return seed != 0 ? seed : 0x9E3779B9; // Zero would never leave zero
+	}
+
+	inline uint8_t nextRandomByte(uint32_t& state) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return (uint8_t)(state >> 24);
+	}
+
+}
@@ -0,0 +1,372 @@
+#include "Recompiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CHP8_RECOMPILER_X64 1
+#endif
+
+using namespace chp8;
+
+/*
+Register use inside a block. rcx and rdx are volatile in both the SysV and Microsoft x64 ABIs, so they hold the
+block's arguments without any saving, and only eax, ah and r8d are used as scratch
+
+	rcx = V register file, each Vx is the byte at [rcx + x]
+	rdx = I register
+	eax = next PC on return
+*/
+static const uint8_t ModRM_AL_V = 0x41; // [rcx + disp8], reg = al
+static const uint8_t ModRM_AH_V = 0x61; // [rcx + disp8], reg = ah
+
+/****************************************************************
+			Recompiler Class
+****************************************************************/
+
+Recompiler::Recompiler() {
+
+}
+
+Recompiler::~Recompiler() {
+	if (codeBuffer == nullptr)
+		return;
+#if defined(_WIN32)
+	VirtualFree(codeBuffer, 0, MEM_RELEASE);
+#else
+	munmap(codeBuffer, CodeBufferSize);
+#endif
+}
+
+bool Recompiler::isSupported() {
+#if defined(CHP8_RECOMPILER_X64)
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool Recompiler::canCompile(Operation op) {
+	switch (op) {
+	case Op1NNN: case Op3XKK: case Op4XKK: case Op5XY0: case Op9XY0:
+	case Op6XKK: case Op7XKK:
+	case Op8XY0: case Op8XY1: case Op8XY2: case Op8XY3: case Op8XY4:
+	case Op8XY5: case Op8XY6: case Op8XY7: case Op8XYE:
+	case OpANNN:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+bool Recompiler::endsBlock(Operation op) {
+	switch (op) {
+	case Op1NNN: case Op3XKK: case Op4XKK: case Op5XY0: case Op9XY0:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+const Recompiler::Block& Recompiler::lookup(uint16_t address) {
+	return blocks[(address >> 1) % BlockTableSize];
+}
+
+const Recompiler::Block& Recompiler::compile(uint16_t address, const Instruction* instructions, int length) {
+	Block& block = blocks[(address >> 1) % BlockTableSize];
+	block.attempted = true;
+	block.code = nullptr;
+	block.length = 0;
+	// Unless the block ended on its own terminator, the instruction that stopped it decides its length too
+	block.span = (uint8_t)(length > 0 && endsBlock(instructions[length - 1].op) ? length : length + 1);
+	const uint8_t span = block.span;
+
+	if (!isSupported() || length <= 0 || invalidations[(address >> 1) % BlockTableSize] >= MaxInvalidations)
+		return block;
+
+	// Each instruction emits at most ~30 bytes, make sure the whole block fits before starting
+	const size_t worstCase = 16 + (size_t)length * 32;
+	if (codeBuffer == nullptr && !allocateCodeBuffer())
+		return block;
+	if (codeUsed + worstCase > CodeBufferSize) {
+		flush();
+		block.attempted = true;
+		block.span = span;
+	}
+
+	setCodeWritable(true);
+	uint8_t* entry = codeBuffer + codeUsed;
+	emitPtr = entry;
+
+#if !defined(_WIN32)
+	// SysV passes the arguments in rdi/rsi, move them to where the Microsoft ABI puts them
+	emit(0x48, 0x89, 0xF9); // mov rcx, rdi
+	emit(0x48, 0x89, 0xF2); // mov rdx, rsi
+#endif
+
+	uint16_t pc = address;
+	for (int i = 0; i < length; i++, pc += 2) {
+		emitInstruction(instructions[i], pc);
+	}
+	// Fell off the end without a terminator, carry on after the last instruction
+	if (!endsBlock(instructions[length - 1].op))
+		emitExit(pc);
+
+	codeUsed += emitPtr - entry;
+	setCodeWritable(false);
+
+	block.code = (BlockFunction)entry;
+	block.length = (uint8_t)length;
+	return block;
+}
+
+void Recompiler::setQuirks(const Quirks& q) {
+	quirks = q;
+	flush();
+}
+
+void Recompiler::invalidate(uint32_t first, uint32_t last) {
+	// Any block starting up to MaxBlockLength instructions before the write could cover it, so one scan covers
+	// a bulk write instead of one per byte
+	uint32_t start = first >= (uint32_t)MaxBlockLength * 2 ? (first - MaxBlockLength * 2) & ~1u : 0;
+	for (; start < last; start += 2) {
+		size_t slot = (start >> 1) % BlockTableSize;
+		Block& block = blocks[slot];
+		if (!block.attempted || start + block.span * 2u <= std::max(start, first))
+			continue;
+
+		block = Block();
+		if (invalidations[slot] < MaxInvalidations) {
+			invalidations[slot]++;
+		}
+	}
+}
+
+void Recompiler::flush() {
+	for (size_t i = 0; i < BlockTableSize; i++) {
+		blocks[i] = Block();
+	}
+	codeUsed = 0;
+}
+
+void Recompiler::reset() {
+	flush();
+	std::memset(invalidations, 0, sizeof(invalidations));
+}
+
+bool Recompiler::allocateCodeBuffer() {
+#if defined(_WIN32)
+	codeBuffer = (uint8_t*)VirtualAlloc(nullptr, CodeBufferSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else
+	void* mapping = mmap(nullptr, CodeBufferSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	codeBuffer = mapping == MAP_FAILED ? nullptr : (uint8_t*)mapping;
+#endif
+	if (codeBuffer == nullptr) {
+		std::cout << "Recompiler::allocateCodeBuffer() failed, staying on the interpreter" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void Recompiler::setCodeWritable(bool writable) {
+	// Never writable and executable at the same time
+#if defined(_WIN32)
+	DWORD old;
+	VirtualProtect(codeBuffer, CodeBufferSize, writable ? PAGE_READWRITE : PAGE_EXECUTE_READ, &old);
+#else
+	mprotect(codeBuffer, CodeBufferSize, writable ? (PROT_READ | PROT_WRITE) : (PROT_READ | PROT_EXEC));
+#endif
+}
+
+/****************************************************************
+			Recompiler Class : Emission
+****************************************************************/
+
+void Recompiler::emit(uint8_t byte) {
+	*emitPtr++ = byte;
+}
+
+void Recompiler::emit(uint8_t a, uint8_t b) {
+	emit(a); emit(b);
+}
+
+void Recompiler::emit(uint8_t a, uint8_t b, uint8_t c) {
+	emit(a); emit(b); emit(c);
+}
+
+void Recompiler::emit32(uint32_t value) {
+	emit(value & 0xFF, (value >> 8) & 0xFF);
+	emit((value >> 16) & 0xFF, (value >> 24) & 0xFF);
+}
+
+void Recompiler::emitExit(uint32_t nextPC) {
+	emit(0xB8); emit32(nextPC); // mov eax, nextPC
+	emit(0xC3); // ret
+}
+
+void Recompiler::emitConditionalExit(uint8_t cmovOpcode, uint32_t notTakenPC, uint32_t takenPC) {
+	// Flags are already set by a compare, neither mov touches them
+	emit(0xB8); emit32(notTakenPC); // mov eax, notTakenPC
+	emit(0x41, 0xB8); emit32(takenPC); // mov r8d, takenPC
+	emit(0x41, 0x0F); emit(cmovOpcode, 0xC0); // cmovcc eax, r8d
+	emit(0xC3); // ret
+}
+
+/*
+Each case mirrors its counterpart in Operations.hpp exactly, including the order VF and Vx are written in,
+so the results match when x or y is F. Quirks are decided here, once per block, so the emitted code has none
+*/
+void Recompiler::emitInstruction(const Instruction& in, uint16_t address) {
+	const uint32_t next = (uint16_t)(address + 2);
+	const uint32_t skip = (uint16_t)(address + 4);
+
+	switch (in.op) {
+	case Op1NNN:
+		emitExit(in.nnn);
+		break;
+
+	case Op3XKK:
+		emit(0x80, 0x79, in.x); emit(in.kk); // cmp byte [rcx + x], kk
+		emitConditionalExit(0x44, next, skip); // cmove
+		break;
+
+	case Op4XKK:
+		emit(0x80, 0x79, in.x); emit(in.kk); // cmp byte [rcx + x], kk
+		emitConditionalExit(0x45, next, skip); // cmovne
+		break;
+
+	case Op5XY0:
+		emit(0x8A, ModRM_AL_V, in.x); // mov al, [rcx + x]
+		emit(0x3A, ModRM_AL_V, in.y); // cmp al, [rcx + y]
+		emitConditionalExit(0x44, next, skip); // cmove
+		break;
+
+	case Op9XY0:
+		emit(0x8A, ModRM_AL_V, in.x); // mov al, [rcx + x]
+		emit(0x3A, ModRM_AL_V, in.y); // cmp al, [rcx + y]
+		emitConditionalExit(0x45, next, skip); // cmovne
+		break;
+
+	case Op6XKK:
+		emit(0xC6, 0x41, in.x); emit(in.kk); // mov byte [rcx + x], kk
+		break;
+
+	case Op7XKK:
+		emit(0x80, 0x41, in.x); emit(in.kk); // add byte [rcx + x], kk
+		break;
+
+	case Op8XY0:
+		emit(0x8A, ModRM_AL_V, in.y); // mov al, [rcx + y]
+		emit(0x88, ModRM_AL_V, in.x); // mov [rcx + x], al
+		break;
+
+	case Op8XY1:
+		if (quirks.logicResetsVF) {
+			// The result is taken before VF is cleared
+			emit(0x8A, ModRM_AL_V, in.x); // mov al, [rcx + x]
+			emit(0x0A, ModRM_AL_V, in.y); // or al, [rcx + y]
+			emit(0xC6, 0x41, 0x0F); emit(0x00); // mov byte [rcx + F], 0
+			emit(0x88, ModRM_AL_V, in.x); // mov [rcx + x], al
+			break;
+		}
+		emit(0x8A, ModRM_AL_V, in.y); // mov al, [rcx + y]
+		emit(0x08, ModRM_AL_V, in.x); // or [rcx + x], al
+		break;
+
+	case Op8XY2:
+		if (quirks.logicResetsVF) {
+			// The result is taken before VF is cleared
+			emit(0x8A, ModRM_AL_V, in.x); // mov al, [rcx + x]
+			emit(0x22, ModRM_AL_V, in.y); // and al, [rcx + y]
+			emit(0xC6, 0x41, 0x0F); emit(0x00); // mov byte [rcx + F], 0
+			emit(0x88, ModRM_AL_V, in.x); // mov [rcx + x], al
+			break;
+		}
+		emit(0x8A, ModRM_AL_V, in.y); // mov al, [rcx + y]
+		emit(0x20, ModRM_AL_V, in.x); // and [rcx + x], al
+		break;
+
+	case Op8XY3:
+		if (quirks.logicResetsVF) {
+			// The result is taken before VF is cleared
+			emit(0x8A, ModRM_AL_V, in.x); // mov al, [rcx + x]
+			emit(0x32, ModRM_AL_V, in.y); // xor al, [rcx + y]
+			emit(0xC6, 0x41, 0x0F); emit(0x00); // mov byte [rcx + F], 0
+			emit(0x88, ModRM_AL_V, in.x); // mov [rcx + x], al
+			break;
+		}
+		emit(0x8A, ModRM_AL_V, in.y); // mov al, [rcx + y]
+		emit(0x30, ModRM_AL_V, in.x); // xor [rcx + x], al
+		break;
+
+	case Op8XY4:
+		// The sum is taken before VF is written
+		emit(0x8A, ModRM_AL_V, in.x); // mov al, [rcx + x]
+		emit(0x02, ModRM_AL_V, in.y); // add al, [rcx + y]
+		emit(0x0F, 0x92, 0xC4); // setc ah
+		emit(0x88, ModRM_AH_V, 0x0F); // mov [rcx + F], ah
+		emit(0x88, ModRM_AL_V, in.x); // mov [rcx + x], al
+		break;
+
+	case Op8XY5:
+		// VF is written before the subtraction reads Vx and Vy
+		emit(0x8A, ModRM_AL_V, in.x); // mov al, [rcx + x]
+		emit(0x3A, ModRM_AL_V, in.y); // cmp al, [rcx + y]
+		emit(0x0F, 0x97, 0xC4); // seta ah
+		emit(0x88, ModRM_AH_V, 0x0F); // mov [rcx + F], ah
+		emit(0x8A, ModRM_AL_V, in.x); // mov al, [rcx + x]
+		emit(0x2A, ModRM_AL_V, in.y); // sub al, [rcx + y]
+		emit(0x88, ModRM_AL_V, in.x); // mov [rcx + x], al
+		break;
+
+	case Op8XY6:
+		// The source is read once, before VF is written
+		emit(0x8A, ModRM_AL_V, quirks.shiftReadsVy ? in.y : in.x); // mov al, [rcx + source]
+		emit(0x88, 0xC4); // mov ah, al
+		emit(0x80, 0xE4, 0x01); // and ah, 1
+		emit(0x88, ModRM_AH_V, 0x0F); // mov [rcx + F], ah
+		emit(0xD0, 0xE8); // shr al, 1
+		emit(0x88, ModRM_AL_V, in.x); // mov [rcx + x], al
+		break;
+
+	case Op8XY7:
+		// VF is written before the subtraction reads Vx and Vy
+		emit(0x8A, ModRM_AL_V, in.y); // mov al, [rcx + y]
+		emit(0x3A, ModRM_AL_V, in.x); // cmp al, [rcx + x]
+		emit(0x0F, 0x97, 0xC4); // seta ah
+		emit(0x88, ModRM_AH_V, 0x0F); // mov [rcx + F], ah
+		emit(0x8A, ModRM_AL_V, in.y); // mov al, [rcx + y]
+		emit(0x2A, ModRM_AL_V, in.x); // sub al, [rcx + x]
+		emit(0x88, ModRM_AL_V, in.x); // mov [rcx + x], al
+		break;
+
+	case Op8XYE:
+		// The source is read once, before VF is written
+		emit(0x8A, ModRM_AL_V, quirks.shiftReadsVy ? in.y : in.x); // mov al, [rcx + source]
+		emit(0x88, 0xC4); // mov ah, al
+		emit(0xC0, 0xEC, 0x07); // shr ah, 7
+		emit(0x88, ModRM_AH_V, 0x0F); // mov [rcx + F], ah
+		emit(0xD0, 0xE0); // shl al, 1
+		emit(0x88, ModRM_AL_V, in.x); // mov [rcx + x], al
+		break;
+
+	case OpANNN:
+		emit(0x66, 0xC7, 0x02); emit(in.nnn & 0xFF, in.nnn >> 8); // mov word [rdx], nnn
+		break;
+
+	default:
+		// canCompile() keeps everything else out of blocks
+		break;
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Instruction.hpp"
+#include "Quirks.hpp"
+
+namespace chp8 {
+
+	/****************************************************************
+			Recompiler Class
+	****************************************************************/
+
+	/*
+	Translates basic blocks of CHIP-8 code into native x86-64. A block runs straight-line register and branch
+	instructions and returns the address to continue at; everything that touches the stack, memory, the display,
+	input or the RNG is left to the interpreter, which also runs a block's terminator when it can't be compiled.
+	On other hosts isSupported() is false and every lookup misses, so callers quietly keep interpreting
+	*/
+	class Recompiler {
+
+	public:
+		/*
+		Compiled block entry point. v points at V0..VF, i at the I register, returns the next PC
+		*/
+		typedef uint32_t (*BlockFunction)(uint8_t* v, uint16_t* i);
+
+		struct Block {
+			BlockFunction code = nullptr; // nullptr if the block couldn't be compiled
+			uint8_t length = 0; // Number of CHIP-8 instructions the block executes
+			uint8_t span = 0; // Number of instructions examined while compiling, for invalidation
+			bool attempted = false; // Set once compilation has been tried at this address
+		};
+
+		static const int MaxBlockLength = 32;
+		static const size_t BlockTableSize = 0x800; // One per even address in 4KB
+		static const size_t CodeBufferSize = 0x40000;
+		static const int MaxInvalidations = 4; // After this many rewrites an address is left to the interpreter
+
+		Recompiler();
+		~Recompiler();
+
+		static bool isSupported();
+		static bool canCompile(Operation op);
+		static bool endsBlock(Operation op);
+
+		const Block& lookup(uint16_t address);
+		const Block& compile(uint16_t address, const Instruction* instructions, int length);
+
+		void setQuirks(const Quirks& q); // Blocks are compiled for one profile's quirks, so this flushes them
+
+		void invalidate(uint32_t first, uint32_t last); // Drops every block covering a byte in [first, last)
+		void flush();
+		void reset(); // flush() and forget how often each address was rewritten
+
+	private:
+		Block blocks[BlockTableSize];
+		uint8_t invalidations[BlockTableSize]{};
+		Quirks quirks;
+
+		uint8_t* codeBuffer = nullptr;
+		size_t codeUsed = 0;
+
+		bool allocateCodeBuffer();
+		void setCodeWritable(bool writable);
+
+		/*
+		Emission
+		*/
+		uint8_t* emitPtr = nullptr;
+
+		void emit(uint8_t byte);
+		void emit(uint8_t a, uint8_t b);
+		void emit(uint8_t a, uint8_t b, uint8_t c);
+		void emit32(uint32_t value);
+
+		void emitInstruction(const Instruction& in, uint16_t address);
+		void emitExit(uint32_t nextPC);
+		void emitConditionalExit(uint8_t cmovOpcode, uint32_t notTakenPC, uint32_t takenPC);
+
+	};
+
+}
@@ -0,0 +1,207 @@
+#include "Rewind.hpp"
+
+#include <cstring>
+
+using namespace chp8;
+
+static const size_t MinGap = 4; // Unchanged bytes shorter than this stay inside a run, a new run costs as much
+
+static uint64_t read64(const uint8_t* p) {
+	uint64_t value;
+	std::memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static uint8_t* writeVarint(uint8_t* out, size_t value) {
+	while (value >= 0x80) {
+		*out++ = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	*out++ = (uint8_t)value;
+	return out;
+}
+
+static const uint8_t* readVarint(const uint8_t* in, size_t& value) {
+	value = 0;
+	for (int shift = 0;; shift += 7) {
+		uint8_t b = *in++;
+		value |= (size_t)(b & 0x7F) << shift;
+		if (!(b & 0x80))
+			return in;
+	}
+}
+
+/*
+Delta encoding: runs of (unchanged bytes to skip, changed byte count, the changed bytes XORed). The worst case is
+a run for every MinGap + 1 bytes, each with two one byte varints
+*/
+static size_t deltaBound(size_t size) {
+	return size + 2 * (size / (MinGap + 1) + 1) + 2 * 8;
+}
+
+static size_t encodeDelta(const uint8_t* before, const uint8_t* after, size_t size, uint8_t* out) {
+	uint8_t* o = out;
+	size_t pos = 0;
+	size_t last = 0; // End of the previous run
+	while (pos < size) {
+		// Skip what didn't change, a word at a time while it can
+		while (pos + 8 <= size && read64(before + pos) == read64(after + pos))
+			pos += 8;
+		while (pos < size && before[pos] == after[pos])
+			pos++;
+		if (pos == size)
+			break;
+
+		// The run ends at the first MinGap unchanged bytes in a row
+		size_t start = pos;
+		size_t end = pos;
+		for (size_t same = 0; pos < size && same < MinGap; pos++) {
+			if (before[pos] != after[pos]) {
+				end = pos + 1;
+				same = 0;
+			}
+			else {
+				same++;
+			}
+		}
+
+		o = writeVarint(o, start - last);
+		o = writeVarint(o, end - start);
+		for (size_t i = start; i < end; i++)
+			*o++ = before[i] ^ after[i];
+		last = end;
+		pos = end;
+	}
+	return o - out;
+}
+
+static void applyDelta(uint8_t* state, size_t size, const uint8_t* delta, size_t deltaSize) {
+	const uint8_t* in = delta;
+	const uint8_t* end = delta + deltaSize;
+	size_t pos = 0;
+	while (in < end) {
+		size_t skip, length;
+		in = readVarint(in, skip);
+		in = readVarint(in, length);
+		pos += skip;
+		if (pos + length > size)
+			return;
+		for (size_t i = 0; i < length; i++)
+			state[pos + i] ^= in[i];
+		in += length;
+		pos += length;
+	}
+}
+
+/****************************************************************
+			Rewind Class
+****************************************************************/
+
+Rewind::Rewind(size_t frames, size_t bytes) : entries(frames > 0 ? frames : 1), ring(bytes) {
+}
+
+void Rewind::clear() {
+	firstEntry = 0;
+	entryCount = 0;
+	writeOffset = 0;
+	bytesUsed = 0;
+	latest.clear();
+}
+
+void Rewind::record(Chip8& chip) {
+	if (!chip.saveState(current, false))
+		return;
+
+	if (latest.empty()) {
+		latest.swap(current);
+		return;
+	}
+
+	bool whole = current.size() != latest.size();
+	size_t bound = whole ? latest.size() : deltaBound(latest.size());
+	uint8_t* out = reserve(bound);
+	if (out == nullptr) {
+		// Too big for the whole ring, so there's no way back past this frame
+		entryCount = 0;
+		writeOffset = 0;
+		bytesUsed = 0;
+		latest.swap(current);
+		return;
+	}
+
+	Entry entry;
+	entry.offset = (uint32_t)writeOffset;
+	entry.whole = whole;
+	if (whole) {
+		std::memcpy(out, latest.data(), latest.size());
+		entry.size = (uint32_t)latest.size();
+	}
+	else {
+		entry.size = (uint32_t)encodeDelta(latest.data(), current.data(), latest.size(), out);
+	}
+
+	if (entryCount == entries.size())
+		dropOldestEntry();
+	entries[(firstEntry + entryCount) % entries.size()] = entry;
+	entryCount++;
+	writeOffset += entry.size;
+	bytesUsed += entry.size;
+
+	latest.swap(current);
+}
+
+bool Rewind::stepBack(Chip8& chip) {
+	if (entryCount == 0)
+		return false;
+
+	Entry& entry = newestEntry();
+	const uint8_t* stored = &ring[entry.offset];
+	if (entry.whole)
+		latest.assign(stored, stored + entry.size);
+	else
+		applyDelta(latest.data(), latest.size(), stored, entry.size);
+
+	// The newest entry is always the last written, so its space is simply handed back
+	writeOffset = entry.offset;
+	bytesUsed -= entry.size;
+	entryCount--;
+
+	return chip.loadState(latest.data(), latest.size());
+}
+
+size_t Rewind::getFrameCount() {
+	return entryCount;
+}
+
+size_t Rewind::getBytesUsed() {
+	return bytesUsed;
+}
+
+Rewind::Entry& Rewind::newestEntry() {
+	return entries[(firstEntry + entryCount - 1) % entries.size()];
+}
+
+void Rewind::dropOldestEntry() {
+	bytesUsed -= entries[firstEntry].size;
+	firstEntry = (firstEntry + 1) % entries.size();
+	entryCount--;
+}
+
+uint8_t* Rewind::reserve(size_t size) {
+	if (size > ring.size())
+		return nullptr;
+
+	// Entries never straddle the end of the ring, one that wouldn't fit starts again at the beginning
+	if (writeOffset + size > ring.size())
+		writeOffset = 0;
+
+	// Anything at or past the write position was recorded before everything behind it, in address order, so
+	// entries are dropped oldest first until the oldest is clear of the space or behind it
+	while (entryCount > 0) {
+		Entry& oldest = entries[firstEntry];
+		if (oldest.offset >= writeOffset + size || oldest.offset < writeOffset)
+			break;
+		dropOldestEntry();
+	}
+	return &ring[writeOffset];
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "CHP-8.hpp"
+
+namespace chp8 {
+
+	/****************************************************************
+			Rewind Class
+	****************************************************************/
+
+	/*
+	Keeps the last few seconds of a chip's history so it can be played backwards a frame at a time. record() takes
+	an uncompressed save state after every frame and stores only its XOR against the one before: runs of unchanged
+	bytes are skipped and the differing bytes kept, so a frame that touched a few bytes of memory and a couple of
+	VRAM rows costs tens of bytes. stepBack() XORs the newest delta back out of the latest state and loads the
+	result.
+
+	Deltas live back to back in a fixed byte ring, oldest dropped first when either it or the frame count runs
+	out. All storage is allocated up front, recording never allocates once the first state has been taken
+	*/
+	class Rewind {
+
+	public:
+		static const size_t DefaultFrames = 3600; // 60 seconds at 60Hz
+		static const size_t DefaultBytes = 512 * 1024;
+
+		Rewind(size_t frames = DefaultFrames, size_t bytes = DefaultBytes);
+
+		void clear(); // Forgets all history, the next record() starts afresh
+
+		/*
+		Records the chip's state, called once after every frame
+		*/
+		void record(Chip8& chip);
+
+		/*
+		Restores the chip to the frame recorded before the latest one, which becomes the latest. Returns false if
+		there is no history left to step back into
+		*/
+		bool stepBack(Chip8& chip);
+
+		size_t getFrameCount(); // Frames stepBack() can still go back
+		size_t getBytesUsed(); // Ring bytes holding those frames
+
+	private:
+		/*
+		One recorded frame. A delta turns the state after it into the state before it. When the state's size
+		changes (a new video mode) the state before is stored whole instead
+		*/
+		struct Entry {
+			uint32_t offset;
+			uint32_t size;
+			bool whole;
+		};
+		std::vector<Entry> entries; // Ring, oldest at firstEntry
+		size_t firstEntry = 0;
+		size_t entryCount = 0;
+
+		std::vector<uint8_t> ring;
+		size_t writeOffset = 0; // Where the next entry goes
+		size_t bytesUsed = 0;
+
+		std::vector<uint8_t> latest; // The most recently recorded (or restored) state
+		std::vector<uint8_t> current; // Scratch for the state being recorded
+
+		Entry& newestEntry();
+		void dropOldestEntry();
+		uint8_t* reserve(size_t size);
+
+	};
+
+}
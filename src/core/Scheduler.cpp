@@ -0,0 +1,273 @@
+#include "Scheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+using namespace chp8;
+
+static const int64_t FrameUnits = 1000000000; // One frame in nanoseconds * FrameHz
+
+/****************************************************************
+			Scheduler Class
+****************************************************************/
+
+Scheduler::Scheduler(Chip8& target, uint32_t hz) : chip(target) {
+	setCpuFrequency(hz);
+}
+
+void Scheduler::setCpuFrequency(uint32_t hz) {
+	cpuHz = hz > 0 ? hz : 1;
+	cycleRemainder = 0;
+}
+
+uint32_t Scheduler::getCpuFrequency() {
+	return cpuHz;
+}
+
+void Scheduler::setCycleCosts(const CycleCosts* costs) {
+	cycleCosts = costs;
+	cycleBudget = 0;
+}
+
+const CycleCosts* Scheduler::getCycleCosts() {
+	return cycleCosts;
+}
+
+void Scheduler::setTurbo(bool enabled) {
+	turbo = enabled;
+	owed = 0; // Leaving turbo shouldn't try to catch up on the time spent in it
+}
+
+bool Scheduler::isTurbo() {
+	return turbo;
+}
+
+void Scheduler::setFastForward(bool held) {
+	if (held != fastForward)
+		owed = 0;
+	fastForward = held;
+}
+
+bool Scheduler::isUnthrottled() {
+	return (turbo || fastForward) && !rewinding;
+}
+
+void Scheduler::setRewind(Rewind* history) {
+	rewind = history;
+	rewinding = false;
+	if (rewind != nullptr)
+		rewind->clear();
+}
+
+void Scheduler::setRewinding(bool held) {
+	held = held && rewind != nullptr && inputLog == nullptr;
+	if (held != rewinding)
+		owed = 0;
+	rewinding = held;
+}
+
+bool Scheduler::isRewinding() {
+	return rewinding;
+}
+
+void Scheduler::setKeys(uint16_t state) {
+	if (playing || state == chip.getKeys())
+		return;
+	chip.setKeys(state);
+	if (inputLog != nullptr)
+		inputLog->recordKeys(cycles - logStartCycle, state);
+}
+
+void Scheduler::record(InputLog* log, uint32_t seed) {
+	inputLog = log;
+	playing = false;
+	rewinding = false;
+	if (inputLog == nullptr)
+		return;
+
+	// Playback starts from the same point in the cycle spreading, and with the keys as they are now
+	chip.setSeed(seed);
+	cycleRemainder = 0;
+	cycleBudget = 0;
+	logStartCycle = cycles;
+	inputLog->begin(seed, cycleCosts != nullptr ? 0 : cpuHz, chip.getQuirkProfile());
+	inputLog->recordKeys(0, chip.getKeys());
+}
+
+void Scheduler::play(InputLog* log) {
+	inputLog = log;
+	playing = log != nullptr;
+	rewinding = false;
+	if (inputLog == nullptr)
+		return;
+
+	chip.setSeed(inputLog->getSeed());
+	chip.setQuirkProfile(inputLog->getQuirkProfile());
+	if (inputLog->getCpuFrequency() == 0) {
+		setCycleCosts(&vipCycleCosts);
+	}
+	else {
+		setCycleCosts(nullptr);
+		setCpuFrequency(inputLog->getCpuFrequency());
+	}
+	logStartCycle = cycles;
+	nextEvent = 0;
+}
+
+bool Scheduler::isPlaying() {
+	return playing;
+}
+
+void Scheduler::setPresentInterval(int interval) {
+	presentInterval = interval > 0 ? interval : 0;
+	framesSincePresent = 0;
+}
+
+int Scheduler::getPresentInterval() {
+	return presentInterval;
+}
+
+bool Scheduler::takePresentDue() {
+	bool due = presentDue;
+	presentDue = false;
+	return due;
+}
+
+double Scheduler::getSpeedMultiplier() {
+	return speedMultiplier;
+}
+
+int Scheduler::advance(int64_t elapsedNs) {
+	int ran = advanceFrames(elapsedNs);
+
+	// Frames are 1/FrameHz of emulated time each, so the multiplier needs no clock of its own
+	speedWindowNs += elapsedNs;
+	speedWindowFrames += ran;
+	if (speedWindowNs >= SpeedWindowNs) {
+		speedMultiplier = (double)speedWindowFrames * FrameUnits / FrameHz / speedWindowNs;
+		speedWindowNs = 0;
+		speedWindowFrames = 0;
+	}
+	return ran;
+}
+
+int Scheduler::advanceFrames(int64_t elapsedNs) {
+	int ran = 0;
+
+	if (isUnthrottled()) {
+		auto start = std::chrono::steady_clock::now();
+		do {
+			runFrame();
+			ran++;
+		} while (chip.isActive() && std::chrono::steady_clock::now() - start < std::chrono::nanoseconds(TurboSliceNs));
+		return ran;
+	}
+
+	owed += elapsedNs * FrameHz;
+	while (owed >= FrameUnits && chip.isActive()) {
+		if (ran == MaxCatchUpFrames) {
+			// The host stalled (a breakpoint, a dragged window), carry on from now instead of fast forwarding
+			owed %= FrameUnits;
+			break;
+		}
+		owed -= FrameUnits;
+		runFrame();
+		ran++;
+	}
+	return ran;
+}
+
+int64_t Scheduler::getNanosUntilNextFrame() {
+	if (isUnthrottled() || owed >= FrameUnits)
+		return 0;
+	return (FrameUnits - owed + FrameHz - 1) / FrameHz;
+}
+
+uint64_t Scheduler::getFrameCount() {
+	return frames;
+}
+
+uint64_t Scheduler::getCycleCount() {
+	return cycles;
+}
+
+int Scheduler::getLastFrameCycles() {
+	return lastFrameCycles;
+}
+
+void Scheduler::runFrame() {
+	if (rewinding) {
+		// Out of history the chip simply stays on the oldest frame
+		lastFrameCycles = 0;
+		if (rewind->stepBack(chip) && frames > 0)
+			frames--;
+	}
+	else if (cycleCosts != nullptr) {
+		// The frame's machine cycles less what the interrupt takes, less whatever the last frame overran by
+		cycleBudget += cycleCosts->frameCycles - cycleCosts->interruptCycles;
+		int ran = playing ? playEventsTimed() : 0;
+		lastFrameCycles = ran + chip.runFrameTimed(*cycleCosts, cycleBudget);
+	}
+	else {
+		// cpuHz / FrameHz each frame, plus one whenever the remainder has built up a whole cycle
+		int count = (int)(cpuHz / FrameHz);
+		cycleRemainder += cpuHz % FrameHz;
+		if (cycleRemainder >= FrameHz) {
+			cycleRemainder -= FrameHz;
+			count++;
+		}
+
+		int ran = playing ? playEvents(count) : 0;
+		lastFrameCycles = ran + chip.runFrame(count - ran);
+	}
+
+	if (!rewinding) {
+		cycles += lastFrameCycles;
+		frames++;
+		if (rewind != nullptr)
+			rewind->record(chip);
+		if (inputLog != nullptr && !playing)
+			inputLog->recordFrame(chip.getFramebuffer().hash());
+	}
+
+	if (presentInterval > 0 && ++framesSincePresent >= presentInterval) {
+		framesSincePresent = 0;
+		presentDue = true;
+	}
+}
+
+int Scheduler::playEvents(int count) {
+	// A change due inside this frame splits it there, the timers still step once at its end
+	const std::vector<InputLog::Event>& events = inputLog->getEvents();
+	uint64_t start = cycles - logStartCycle;
+	int ran = 0;
+	while (nextEvent < events.size() && events[nextEvent].cycle < start + count) {
+		uint64_t due = events[nextEvent].cycle;
+		if (due > start + ran)
+			ran += chip.execute((int)(due - start - ran));
+		chip.setKeys(events[nextEvent].keys);
+		nextEvent++;
+	}
+	return ran;
+}
+
+int Scheduler::playEventsTimed() {
+	// As playEvents(), but where the frame ends is only known once its cycles run out. Changes were recorded
+	// between frames, so one due exactly where this frame runs out is left for the start of the next
+	const std::vector<InputLog::Event>& events = inputLog->getEvents();
+	uint64_t start = cycles - logStartCycle;
+	int ran = 0;
+	while (nextEvent < events.size() && cycleBudget > 0) {
+		uint64_t due = events[nextEvent].cycle;
+		if (due > start + ran) {
+			int wanted = (int)std::min<uint64_t>(due - start - ran, std::numeric_limits<int>::max());
+			ran += chip.executeTimed(*cycleCosts, cycleBudget, wanted);
+			if (start + ran < due || cycleBudget <= 0) // Out of cycles first, runFrameTimed() ends the frame
+				break;
+		}
+		chip.setKeys(events[nextEvent].keys);
+		nextEvent++;
+	}
+	return ran;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+
+#include "CHP-8.hpp"
+#include "CycleCosts.hpp"
+#include "InputLog.hpp"
+#include "Rewind.hpp"
+
+namespace chp8 {
+
+	/****************************************************************
+			Scheduler Class
+	****************************************************************/
+
+	/*
+	Turns host time into emulated frames. Emulated time advances in 60Hz frames: each one runs the CPU for its
+	share of the configured frequency, steps the timers once and is a frame the display can present. All
+	accounting is in integers, host time in nanoseconds scaled by 60 so a frame is exactly 10^9 units, and cycles
+	spread over frames so that every 60 frames run exactly cpuHz instructions. Nothing drifts however long it runs.
+
+	With CycleCosts set, frames are timed in machine cycles instead: each frame gets the cycles between two
+	interrupts, instructions are charged what they cost on the original machine, and whatever the last one
+	overruns by comes out of the next frame. cpuHz is then unused.
+
+	In turbo, or while fast forward is held, frames run back to back for as long as one advance() is allowed to
+	take, so the CPU goes as fast as the host allows and the timers still step once every cpuHz / 60 instructions.
+	Frontends present every presentInterval-th frame, or none at all.
+
+	With a Rewind attached every frame is recorded into it. While rewinding is held each frame steps back one
+	recorded frame instead of running one, always at 60Hz whatever turbo says.
+
+	Nothing here reads the host clock except to decide how many frames are due, so a run is fully determined by
+	its program, seed, frequency and keypad changes. An InputLog records those and plays them back
+	*/
+	class Scheduler {
+
+	public:
+		static const uint32_t FrameHz = 60;
+		static const uint32_t DefaultCpuHz = 600;
+		static const int MaxCatchUpFrames = 4; // Past this, time owed is dropped rather than run in a burst
+		static const int64_t TurboSliceNs = 16000000; // Host time one advance() spends running frames in turbo
+		static const int64_t SpeedWindowNs = 500000000; // Host time the speed multiplier is averaged over
+
+		Scheduler(Chip8& target, uint32_t cpuHz = DefaultCpuHz);
+
+		void setCpuFrequency(uint32_t hz);
+		uint32_t getCpuFrequency();
+
+		/*
+		nullptr (the default) runs cpuHz instructions a second on the selected engine. Otherwise frames are timed
+		by costs on the interpreter, see CycleCosts.hpp
+		*/
+		void setCycleCosts(const CycleCosts* costs);
+		const CycleCosts* getCycleCosts();
+
+		void setTurbo(bool enabled);
+		bool isTurbo();
+		void setFastForward(bool held); // Turbo for as long as it is held, whatever setTurbo() says
+		bool isUnthrottled(); // Turbo or fast forward, and not rewinding
+
+		void setRewind(Rewind* history); // nullptr stops recording
+		void setRewinding(bool held); // Ignored while recording or playing an InputLog, it can't express going back
+		bool isRewinding();
+
+		/*
+		Keypad input, passed on to the chip and recorded when it changes. Ignored while playing back
+		*/
+		void setKeys(uint16_t state);
+
+		/*
+		Replay. record() seeds the chip and from then on logs every keypad change and the framebuffer hash after
+		every frame. play() seeds the chip and sets its quirk profile and the frequency or cycle timing from the
+		log, then applies its keypad changes before the same instructions they were recorded at. Both expect the
+		chip fresh from reset() and loadProgram(). nullptr stops either
+		*/
+		void record(InputLog* log, uint32_t seed = DefaultRandomSeed);
+		void play(InputLog* log);
+		bool isPlaying();
+
+		/*
+		Runs one frame now, whatever the clock says. For headless runs that go as fast as they can
+		*/
+		void runFrame();
+
+		/*
+		Presentation. 1 presents every frame, n every n-th, 0 none
+		*/
+		void setPresentInterval(int interval);
+		int getPresentInterval();
+		bool takePresentDue(); // True if a frame to present has run since the last call
+
+		/*
+		Emulated time over host time, measured over the last SpeedWindowNs
+		*/
+		double getSpeedMultiplier();
+
+		/*
+		Accounts for elapsedNs of host time and runs every frame that became due. Returns the number of frames
+		run
+		*/
+		int advance(int64_t elapsedNs);
+
+		/*
+		Host time until the next frame is due, for frontends to sleep on. Zero when unthrottled
+		*/
+		int64_t getNanosUntilNextFrame();
+
+		uint64_t getFrameCount();
+		uint64_t getCycleCount(); // Instructions run since construction
+		int getLastFrameCycles(); // Instructions the most recent frame ran
+
+	private:
+		Chip8& chip;
+		uint32_t cpuHz;
+		bool turbo = false;
+		bool fastForward = false;
+		Rewind* rewind = nullptr;
+		bool rewinding = false;
+
+		InputLog* inputLog = nullptr;
+		bool playing = false;
+		size_t nextEvent = 0; // Next event to play
+		uint64_t logStartCycle = 0; // Cycle count when the log started, its cycles are relative to this
+
+		int presentInterval = 1;
+		int framesSincePresent = 0;
+		bool presentDue = false;
+
+		int64_t speedWindowNs = 0;
+		uint64_t speedWindowFrames = 0;
+		double speedMultiplier = 1.0;
+
+		int64_t owed = 0; // Host time not yet run, in nanoseconds * FrameHz
+		uint32_t cycleRemainder = 0; // Carries cpuHz % FrameHz between frames
+		const CycleCosts* cycleCosts = nullptr;
+		int64_t cycleBudget = 0; // Machine cycles left this frame, negative while paying off the last one
+
+		uint64_t frames = 0;
+		uint64_t cycles = 0;
+		int lastFrameCycles = 0;
+
+		int advanceFrames(int64_t elapsedNs);
+		int playEvents(int count);
+		int playEventsTimed();
+
+	};
+
+}
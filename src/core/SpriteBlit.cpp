@@ -0,0 +1,138 @@
+#include "SpriteBlit.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CHP8_BLIT_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(CHP8_BLIT_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CHP8_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CHP8_TARGET_AVX2
+#endif
+
+using namespace chp8;
+
+/****************************************************************
+			Sprite Blitting
+****************************************************************/
+
+bool chp8::blitSprite(uint64_t* vram, size_t wordsPerRow, unsigned int width, unsigned int height,
+	unsigned int x, unsigned int y, const uint64_t* rows, unsigned int count) {
+	if (x >= width || y >= height || wordsPerRow > MaxRowWords)
+		return false;
+
+	// Rows past the bottom edge are clipped
+	if (count > height - y)
+		count = height - y;
+	if (count > MaxSpriteRows)
+		count = MaxSpriteRows;
+
+	// Shift every row into place. A row covers word x / 64 and, unless x is word aligned, spills into the next,
+	// which only exists in the 128 pixel wide modes
+	uint64_t shifted[MaxSpriteRows * MaxRowWords] = {};
+	size_t word = x >> 6;
+	unsigned int shift = x & 63;
+	bool spills = shift != 0 && word + 1 < wordsPerRow;
+	for (unsigned int i = 0; i < count; i++) {
+		uint64_t* out = &shifted[i * wordsPerRow];
+		out[word] = rows[i] >> shift;
+		if (spills)
+			out[word + 1] = rows[i] << (64 - shift);
+	}
+
+	// Consecutive rows are consecutive in VRAM, so the whole sprite is one run of words
+	return xorBlit(&vram[y * wordsPerRow], shifted, count * wordsPerRow) != 0;
+}
+
+uint64_t chp8::xorBlitScalar(uint64_t* dst, const uint64_t* src, size_t words) {
+	uint64_t collided = 0;
+	for (size_t i = 0; i < words; i++) {
+		collided |= dst[i] & src[i];
+		dst[i] ^= src[i];
+	}
+	return collided;
+}
+
+uint64_t chp8::xorBlitSSE2(uint64_t* dst, const uint64_t* src, size_t words) {
+#if defined(CHP8_BLIT_X86)
+	__m128i collided = _mm_setzero_si128();
+	size_t i = 0;
+	for (; i + 2 <= words; i += 2) {
+		__m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+		__m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		collided = _mm_or_si128(collided, _mm_and_si128(d, s));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_xor_si128(d, s));
+	}
+	uint64_t lanes[2];
+	_mm_storeu_si128((__m128i*)lanes, collided);
+	return lanes[0] | lanes[1] | xorBlitScalar(dst + i, src + i, words - i);
+#else
+	return xorBlitScalar(dst, src, words);
+#endif
+}
+
+CHP8_TARGET_AVX2 uint64_t chp8::xorBlitAVX2(uint64_t* dst, const uint64_t* src, size_t words) {
+#if defined(CHP8_BLIT_X86)
+	// A 16 row sprite is 16 words at 64 pixels wide and 32 at 128, four or eight iterations
+	__m256i collided = _mm256_setzero_si256();
+	size_t i = 0;
+	for (; i + 4 <= words; i += 4) {
+		__m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+		__m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+		collided = _mm256_or_si256(collided, _mm256_and_si256(d, s));
+		_mm256_storeu_si256((__m256i*)(dst + i), _mm256_xor_si256(d, s));
+	}
+	// Finish the tail here rather than in the SSE2 kernel, mixing in legacy SSE code costs more than the tail itself
+	__m128i tail = _mm_or_si128(_mm256_castsi256_si128(collided), _mm256_extracti128_si256(collided, 1));
+	for (; i + 2 <= words; i += 2) {
+		__m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+		__m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		tail = _mm_or_si128(tail, _mm_and_si128(d, s));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_xor_si128(d, s));
+	}
+	uint64_t lanes[2];
+	_mm_storeu_si128((__m128i*)lanes, tail);
+	uint64_t result = lanes[0] | lanes[1];
+	if (i < words) {
+		result |= dst[i] & src[i];
+		dst[i] ^= src[i];
+	}
+	_mm256_zeroupper();
+	return result;
+#else
+	return xorBlitScalar(dst, src, words);
+#endif
+}
+
+bool chp8::hasAVX2() {
+#if defined(CHP8_BLIT_X86) && (defined(__GNUC__) || defined(__clang__))
+	return __builtin_cpu_supports("avx2");
+#elif defined(CHP8_BLIT_X86) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+	__cpuidex(info, 7, 0);
+	bool avx2 = (info[1] & (1 << 5)) != 0;
+	// The OS also has to save the YMM registers
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	return avx2 && osxsave && (_xgetbv(0) & 0x6) == 0x6;
+#else
+	return false;
+#endif
+}
+
+static XorBlitKernel selectKernel() {
+#if defined(CHP8_BLIT_X86)
+	return hasAVX2() ? &xorBlitAVX2 : &xorBlitSSE2;
+#else
+	return &xorBlitScalar;
+#endif
+}
+
+const XorBlitKernel chp8::xorBlit = selectKernel();
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace chp8 {
+
+	/****************************************************************
+			Sprite Blitting
+	****************************************************************/
+
+	/*
+	Sprite drawing on packed VRAM (rows of 64-bit words, most significant bit leftmost, see MonoVideo). A sprite is
+	first shifted into the words of the rows it covers, then XORed into VRAM as one contiguous run of words.
+	Collision is the OR of (old & sprite) over the whole run, so there is no branch per pixel or per row
+	*/
+
+	static const unsigned int MaxSpriteRows = 16;
+	static const size_t MaxRowWords = 2;
+
+	/*
+	XORs rows (left aligned, bit 63 is the sprite's leftmost pixel) into vram at (x, y), clipping at the right and
+	bottom edges. Returns true if any lit pixel was turned off
+	*/
+	bool blitSprite(uint64_t* vram, size_t wordsPerRow, unsigned int width, unsigned int height,
+		unsigned int x, unsigned int y, const uint64_t* rows, unsigned int count);
+
+	/*
+	XOR kernels: dst ^= src over words, returning the OR of (dst & src) from before the XOR. xorBlit points at the
+	fastest one the host supports
+	*/
+	typedef uint64_t (*XorBlitKernel)(uint64_t* dst, const uint64_t* src, size_t words);
+	extern const XorBlitKernel xorBlit;
+
+	uint64_t xorBlitScalar(uint64_t* dst, const uint64_t* src, size_t words);
+	uint64_t xorBlitSSE2(uint64_t* dst, const uint64_t* src, size_t words); // Scalar where SSE2 isn't available
+	uint64_t xorBlitAVX2(uint64_t* dst, const uint64_t* src, size_t words); // Only call if hasAVX2()
+	bool hasAVX2();
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace chp8 {
+
+	/****************************************************************
+			SpscRing Class
+	****************************************************************/
+
+	/*
+	Lock-free ring buffer for exactly one producer thread and one consumer thread. Capacity must be a power of two.
+	Head and tail live on separate cache lines, and each side keeps a private copy of the other's index so the
+	shared one is only re-read when the ring looks full (or empty)
+	*/
+	template <typename T, size_t Capacity>
+	class SpscRing {
+		static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+	public:
+		/*
+		Producer side. Returns false if the ring is full
+		*/
+		bool push(const T& item) {
+			size_t h = head.load(std::memory_order_relaxed);
+			if (h - producerTail == Capacity) {
+				producerTail = tail.load(std::memory_order_acquire);
+				if (h - producerTail == Capacity)
+					return false;
+			}
+			items[h & (Capacity - 1)] = item;
+			head.store(h + 1, std::memory_order_release);
+			return true;
+		}
+
+		/*
+		Consumer side. Copies out up to max items, returns how many
+		*/
+		size_t pop(T* out, size_t max) {
+			size_t t = tail.load(std::memory_order_relaxed);
+			if (consumerHead == t)
+				consumerHead = head.load(std::memory_order_acquire);
+			size_t available = consumerHead - t;
+			size_t n = available < max ? available : max;
+			for (size_t i = 0; i < n; i++) {
+				out[i] = items[(t + i) & (Capacity - 1)];
+			}
+			tail.store(t + n, std::memory_order_release);
+			return n;
+		}
+
+		bool pop(T& out) {
+			return pop(&out, 1) == 1;
+		}
+
+		bool isEmpty() {
+			return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+		}
+
+	private:
+		alignas(64) std::atomic<size_t> head{ 0 };
+		size_t producerTail = 0;
+
+		alignas(64) std::atomic<size_t> tail{ 0 };
+		size_t consumerHead = 0;
+
+		alignas(64) T items[Capacity];
+
+	};
+
+}
@@ -0,0 +1,199 @@
+#include "Tracer.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace chp8;
+
+/****************************************************************
+			Tracer Class Static Defs
+****************************************************************/
+
+const char Tracer::Magic[8] = { 'C', 'H', 'P', '8', 'T', 'R', 'C', '\0' };
+
+/****************************************************************
+			Tracer Class
+****************************************************************/
+
+Tracer::Tracer() {
+
+}
+
+Tracer::~Tracer() {
+	close();
+}
+
+bool Tracer::open(const std::string& path) {
+	close();
+	filePath = path;
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		std::cout << "Tracer::open(" << path << ") failed to create the file" << std::endl;
+		return false;
+	}
+	fileHandle = file;
+#else
+	fileDescriptor = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fileDescriptor < 0) {
+		std::cout << "Tracer::open(" << path << ") failed to create the file" << std::endl;
+		return false;
+	}
+#endif
+
+	if (!mapFile(FileGrowth)) {
+		close();
+		return false;
+	}
+
+	FileHeader header;
+	std::memcpy(header.magic, Magic, sizeof(header.magic));
+	header.version = Version;
+	header.recordSize = sizeof(Record);
+	std::memcpy(mapping, &header, sizeof(header));
+	fileUsed = sizeof(header);
+
+	stalls = 0;
+	recordsWritten = 0;
+	running = true;
+	writer = std::thread(&Tracer::drain, this);
+	return true;
+}
+
+void Tracer::close() {
+	if (writer.joinable()) {
+		running = false;
+		writer.join(); // The writer empties the ring before it exits
+	}
+
+	unmapFile();
+
+#if defined(_WIN32)
+	if (fileHandle != nullptr) {
+		// Cut the file back from the mapping's size to what was actually written
+		LARGE_INTEGER size;
+		size.QuadPart = (LONGLONG)fileUsed;
+		SetFilePointerEx((HANDLE)fileHandle, size, nullptr, FILE_BEGIN);
+		SetEndOfFile((HANDLE)fileHandle);
+		CloseHandle((HANDLE)fileHandle);
+		fileHandle = nullptr;
+	}
+#else
+	if (fileDescriptor >= 0) {
+		if (ftruncate(fileDescriptor, (off_t)fileUsed) != 0)
+			std::cout << "Tracer::close() failed to truncate " << filePath << std::endl;
+		::close(fileDescriptor);
+		fileDescriptor = -1;
+	}
+#endif
+
+	fileUsed = 0;
+}
+
+bool Tracer::isOpen() {
+	return writer.joinable();
+}
+
+uint64_t Tracer::getStallCount() {
+	return stalls;
+}
+
+uint64_t Tracer::getRecordsWritten() {
+	return recordsWritten;
+}
+
+void Tracer::drain() {
+	static const size_t Batch = 4096;
+	bool outOfDisk = false;
+
+	for (;;) {
+		// Read the flag before draining, so once it's seen false one more pass empties everything pushed before it
+		bool keepRunning = running.load(std::memory_order_acquire);
+
+		size_t drained = 0;
+		for (;;) {
+			// A failed remap leaves nothing mapped, so it isn't retried: that would map from size 0 again
+			if (!outOfDisk && fileUsed + Batch * sizeof(Record) > mappedSize && !mapFile(mappedSize + FileGrowth))
+				outOfDisk = true;
+			if (outOfDisk) {
+				// Drop what's left so the emulator never blocks forever
+				Record discard;
+				while (ring.pop(discard)) {}
+				break;
+			}
+
+			// Records go straight from the ring into the mapping
+			size_t n = ring.pop((Record*)(mapping + fileUsed), Batch);
+			if (n == 0)
+				break;
+			fileUsed += n * sizeof(Record);
+			recordsWritten += n;
+			drained += n;
+		}
+
+		if (!keepRunning)
+			return;
+		if (drained == 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+bool Tracer::mapFile(size_t size) {
+	unmapFile();
+
+#if defined(_WIN32)
+	HANDLE mappingObject = CreateFileMappingA((HANDLE)fileHandle, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)(size & 0xFFFFFFFF), nullptr);
+	if (mappingObject == nullptr) {
+		std::cout << "Tracer::mapFile(" << size << ") failed to create the mapping" << std::endl;
+		return false;
+	}
+	mapping = (uint8_t*)MapViewOfFile(mappingObject, FILE_MAP_WRITE, 0, 0, size);
+	mappingHandle = mappingObject;
+#else
+	if (ftruncate(fileDescriptor, (off_t)size) != 0) {
+		std::cout << "Tracer::mapFile(" << size << ") failed to grow " << filePath << std::endl;
+		return false;
+	}
+	void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+	mapping = view == MAP_FAILED ? nullptr : (uint8_t*)view;
+#endif
+
+	if (mapping == nullptr) {
+		std::cout << "Tracer::mapFile(" << size << ") failed to map " << filePath << std::endl;
+		return false;
+	}
+	mappedSize = size;
+	return true;
+}
+
+void Tracer::unmapFile() {
+	if (mapping != nullptr) {
+#if defined(_WIN32)
+		UnmapViewOfFile(mapping);
+#else
+		munmap(mapping, mappedSize);
+#endif
+		mapping = nullptr;
+	}
+
+#if defined(_WIN32)
+	if (mappingHandle != nullptr) {
+		CloseHandle((HANDLE)mappingHandle);
+		mappingHandle = nullptr;
+	}
+#endif
+
+	mappedSize = 0;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "SpscRing.hpp"
+
+namespace chp8 {
+
+	/****************************************************************
+			Tracer Class
+	****************************************************************/
+
+	/*
+	Records every executed instruction as a compact binary record. The emulation thread only copies records into a
+	lock-free ring, a background thread drains the ring into a memory-mapped trace file. tools/TraceDump.cpp turns
+	the file back into text
+	*/
+	class Tracer {
+
+	public:
+		struct Record {
+			uint16_t pc; // Address of the instruction
+			uint16_t opcode;
+			uint16_t i; // I after the instruction
+			uint16_t changed; // Bit n set if Vn changed
+			uint8_t values[8]; // New values of the first eight changed registers, lowest register first
+		};
+
+		/*
+		Trace file layout: a FileHeader, then Records back to back until the end of the file
+		*/
+		struct FileHeader {
+			char magic[8];
+			uint32_t version;
+			uint32_t recordSize;
+		};
+		static const char Magic[8];
+		static const uint32_t Version = 1;
+
+		static const size_t RingCapacity = 0x10000;
+		static const size_t FileGrowth = 0x1000000; // The mapping grows 16MB at a time
+
+		Tracer();
+		~Tracer();
+
+		bool open(const std::string& path);
+		void close();
+		bool isOpen();
+
+		/*
+		Emulation thread only. Waits for the writer if the ring is full, so no records are ever lost
+		*/
+		inline void record(const Record& r) {
+			if (!ring.push(r)) {
+				stalls++;
+				while (!ring.push(r))
+					std::this_thread::yield();
+			}
+		}
+
+		uint64_t getStallCount();
+		uint64_t getRecordsWritten();
+
+	private:
+		SpscRing<Record, RingCapacity> ring;
+		uint64_t stalls = 0;
+
+		std::thread writer;
+		std::atomic<bool> running{ false };
+		std::atomic<uint64_t> recordsWritten{ 0 };
+
+		void drain();
+
+		/*
+		Memory-mapped output
+		*/
+		std::string filePath;
+#if defined(_WIN32)
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+#else
+		int fileDescriptor = -1;
+#endif
+		uint8_t* mapping = nullptr;
+		size_t mappedSize = 0;
+		size_t fileUsed = 0;
+
+		bool mapFile(size_t size);
+		void unmapFile();
+
+	};
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace chp8 {
+
+	/****************************************************************
+			TripleBuffer Class
+	****************************************************************/
+
+	/*
+	Lock-free hand over of the latest value from one writer thread to one reader thread. The writer fills its back
+	slot and publishes it, the reader picks up whatever was published last. Neither side ever waits for the other:
+	values the reader didn't get to in time are simply replaced by newer ones.
+
+	The three slots rotate through back (writer's), middle (last published) and front (reader's). Only the middle
+	index is shared, with a bit saying whether it holds something the reader hasn't seen yet
+	*/
+	template <typename T>
+	class TripleBuffer {
+
+	public:
+		/*
+		Writer side. write() is the slot to fill, publish() hands it over and starts on another one
+		*/
+		T& write() {
+			return slots[back];
+		}
+
+		void publish() {
+			back = middle.exchange(back | Fresh, std::memory_order_acq_rel) & Index;
+		}
+
+		/*
+		Reader side. update() returns true and moves read() to the newest value if one was published since the
+		last call
+		*/
+		bool update() {
+			if ((middle.load(std::memory_order_relaxed) & Fresh) == 0)
+				return false;
+			front = middle.exchange(front, std::memory_order_acq_rel) & Index;
+			return true;
+		}
+
+		const T& read() {
+			return slots[front];
+		}
+
+	private:
+		static const uint8_t Index = 3;
+		static const uint8_t Fresh = 4;
+
+		T slots[3];
+
+		alignas(64) std::atomic<uint8_t> middle{ 1 };
+		alignas(64) uint8_t back = 0;
+		alignas(64) uint8_t front = 2;
+
+	};
+
+}
@@ -0,0 +1,35 @@
+#include "FrameConverter.hpp"
+
+#include <cstring>
+
+using namespace chp8;
+
+/****************************************************************
+			FrameConverter Class
+****************************************************************/
+
+FrameConverter::FrameConverter(uint32_t activeColor, uint32_t inactiveColor) {
+	for (unsigned int byte = 0; byte < 256; byte++)
+		for (unsigned int bit = 0; bit < 8; bit++)
+			expandTable[byte][bit] = (byte >> (7 - bit)) & 1 ? activeColor : inactiveColor;
+}
+
+void FrameConverter::setVideoMode(Framebuffer::VideoMode vmode) {
+	mode = vmode;
+	pixels.assign(mode.width * mode.height, 0);
+}
+
+void FrameConverter::convertRow(Framebuffer& source, unsigned int y) {
+	const uint64_t* row = source.getRow(y);
+	size_t wordsPerRow = source.getWordsPerRow();
+	uint32_t* out = &pixels[y * mode.width];
+	for (size_t word = 0; word < wordsPerRow; word++) {
+		for (unsigned int byte = 0; byte < 8; byte++, out += 8) {
+			std::memcpy(out, expandTable[(row[word] >> (56 - byte * 8)) & 0xFF], sizeof(expandTable[0]));
+		}
+	}
+}
+
+const uint32_t* FrameConverter::getRow(unsigned int y) {
+	return &pixels[y * mode.width];
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../core/Framebuffer.hpp"
+
+namespace chp8 {
+
+	/****************************************************************
+			FrameConverter Class
+	****************************************************************/
+
+	/*
+	Turns packed framebuffer rows into 32-bit RGBA pixels for a texture, a byte (8 pixels) at a time through a
+	lookup table. Plain C++ with no SFML, so the conversion can be measured and tested without a window
+	*/
+	class FrameConverter {
+
+	public:
+		/*
+		Colours are packed in texture memory order, R G B A
+		*/
+		FrameConverter(uint32_t activeColor, uint32_t inactiveColor);
+
+		void setVideoMode(Framebuffer::VideoMode vmode);
+
+		void convertRow(Framebuffer& source, unsigned int y);
+		const uint32_t* getRow(unsigned int y); // mode.width pixels, rows follow each other
+
+	private:
+		Framebuffer::VideoMode mode = { 0, 0 };
+		uint32_t expandTable[256][8];
+		std::vector<uint32_t> pixels; // RGBA staging for the whole screen
+
+	};
+
+}
@@ -0,0 +1,123 @@
+#include "InfoWindow.hpp"
+
+#include <cstdio>
+#include <iostream>
+
+#include <SFML/Graphics.hpp>
+
+using namespace chp8;
+
+/****************************************************************
+			InfoWindow Class
+****************************************************************/
+
+void DebugSnapshot::capture(Chip8& chip, Scheduler& scheduler, float elapsed) {
+	dt = elapsed;
+	cpuHz = scheduler.getCycleCosts() != nullptr ? 0 : scheduler.getCpuFrequency();
+	speed = scheduler.getSpeedMultiplier();
+	rewinding = scheduler.isRewinding();
+	unthrottled = scheduler.isUnthrottled();
+	frameCount = scheduler.getFrameCount();
+	lastFrameCycles = scheduler.getLastFrameCycles();
+
+	for (uint8_t i = 0; i < 0x10; i++) {
+		v[i] = chip.getRegister(i);
+		stack[i] = chip.getStackEntry(i);
+	}
+	sound = chip.getSoundTimer();
+	delay = chip.getDelayTimer();
+	pc = chip.getPC();
+	sp = chip.getSP();
+}
+
+InfoWindow::InfoWindow() {
+	infoWindow.create(sf::VideoMode(280, 320), "CHP-8 INFO");
+	infoWindow.setPosition(sf::Vector2i(0,0));
+
+	if (!font.loadFromFile("CONSOLA.TTF")) {
+		// Failed to load, abort
+		std::cout << "Failed to load font, aborting" << std::endl;
+		return;
+	}
+
+	overlay.setFont(font, 14);
+	buildLayout();
+
+	windowActive = true;
+}
+
+void InfoWindow::buildLayout() {
+	timeField = overlay.addField(10, 5, 32);
+	cpuField = overlay.addField(10, 19, 40);
+	frameField = overlay.addField(10, 33, 48);
+
+	// Registers in two columns, then the timers, PC and SP
+	for (int i = 0; i < 0x10; i++)
+		registerFields[i] = overlay.addField(10.0f + 80 * (i % 2), 50.0f + 16 * (i / 2), 8);
+	soundField = overlay.addField(10, 178, 8);
+	delayField = overlay.addField(90, 178, 8);
+	pcField = overlay.addField(10, 194, 8);
+	spField = overlay.addField(10, 210, 8);
+
+	for (int i = 0; i < StackLines; i++)
+		stackFields[i] = overlay.addField(10, 230.0f + 14 * i, 20);
+}
+
+bool InfoWindow::isActive() {
+	return windowActive;
+}
+
+void InfoWindow::render(const DebugSnapshot& state) {
+	char text[64];
+
+	// Display the timing information
+	std::snprintf(text, sizeof(text), "dt = %f seconds", state.dt);
+	overlay.setText(timeField, text);
+
+	char rate[16] = "VIP cycles";
+	if (state.cpuHz != 0)
+		std::snprintf(rate, sizeof(rate), "%u Hz", state.cpuHz);
+	std::snprintf(text, sizeof(text), "CPU: %s, %.2fx%s", rate, state.speed,
+		state.rewinding ? " (rewinding)" : state.unthrottled ? " (turbo)" : "");
+	overlay.setText(cpuField, text);
+
+	std::snprintf(text, sizeof(text), "frame %llu: %d instructions", (unsigned long long)state.frameCount, state.lastFrameCycles);
+	overlay.setText(frameField, text);
+
+	// Display the registers
+	for (uint8_t i = 0; i < 0x10; i++) {
+		std::snprintf(text, sizeof(text), "V%X: %02X", i, state.v[i]);
+		overlay.setText(registerFields[i], text);
+	}
+
+	std::snprintf(text, sizeof(text), "SD: %02X", state.sound);
+	overlay.setText(soundField, text);
+	std::snprintf(text, sizeof(text), "DL: %02X", state.delay);
+	overlay.setText(delayField, text);
+	std::snprintf(text, sizeof(text), "PC: %04X", state.pc);
+	overlay.setText(pcField, text);
+	std::snprintf(text, sizeof(text), "SP: %02X", state.sp);
+	overlay.setText(spField, text);
+
+	// Display stack, from up to 3 slots above SP down to 5 entries
+	uint8_t sp = state.sp;
+	int line = 0;
+	for (int i = sp + 3, c = 0; i >= 0 && c < 5; i--, line++) {
+		if (i >= 0x10) {
+			std::snprintf(text, sizeof(text), "Stack @ [%X] = X", i);
+		}
+		else {
+			std::snprintf(text, sizeof(text), "Stack @ [%X] = %04X", i, state.stack[i]);
+			c++;
+		}
+		overlay.setText(stackFields[line], text);
+		overlay.setColor(stackFields[line], i == sp ? sf::Color(80, 80, 255) : sf::Color::White);
+	}
+	for (; line < StackLines; line++)
+		overlay.setText(stackFields[line], "");
+
+	// Update window
+	infoWindow.clear(sf::Color::Black);
+	overlay.draw(infoWindow);
+	infoWindow.display();
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/Font.hpp>
+
+#include "../core/CHP-8.hpp"
+#include "../core/Scheduler.hpp"
+#include "TextOverlay.hpp"
+
+namespace chp8 {
+
+	/****************************************************************
+			InfoWindow Class
+	****************************************************************/
+
+	/*
+	Everything the info window shows, copied out by the emulation thread so the window never touches a running
+	Chip8
+	*/
+	struct DebugSnapshot {
+		float dt;
+		uint32_t cpuHz; // 0 when the scheduler is timing by cycle costs
+		double speed;
+		bool rewinding;
+		bool unthrottled;
+		uint64_t frameCount;
+		int lastFrameCycles;
+
+		uint8_t v[0x10];
+		uint8_t sound;
+		uint8_t delay;
+		uint16_t pc;
+		uint8_t sp;
+		uint16_t stack[0x10];
+
+		void capture(Chip8& chip, Scheduler& scheduler, float elapsed);
+	};
+
+	/*
+	Debug window showing a Chip8's registers, stack and timing, from snapshots
+	*/
+	class InfoWindow {
+
+	public:
+		InfoWindow();
+
+		void render(const DebugSnapshot& state);
+
+		bool isActive(); // False if the window couldn't be set up
+
+	private:
+		bool windowActive = false;
+
+		sf::Font font;
+		sf::RenderWindow infoWindow;
+
+		/*
+		Every line is a field of one overlay, updated in place each frame
+		*/
+		static const int StackLines = 8; // Up to 3 empty slots above SP, then 5 entries
+		TextOverlay overlay;
+		size_t timeField;
+		size_t cpuField;
+		size_t frameField;
+		size_t registerFields[0x10];
+		size_t soundField;
+		size_t delayField;
+		size_t pcField;
+		size_t spField;
+		size_t stackFields[StackLines];
+
+		void buildLayout();
+
+	};
+
+}
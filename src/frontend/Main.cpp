@@ -0,0 +1,260 @@
+/*
+
+CHP-8
+
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Sleep.hpp>
+
+#include "../core/CHP-8.hpp"
+#include "../core/InputLog.hpp"
+#include "../core/Profiler.hpp"
+#include "../core/Rewind.hpp"
+#include "../core/Scheduler.hpp"
+#include "../core/SpscRing.hpp"
+#include "../core/Tracer.hpp"
+#include "../core/TripleBuffer.hpp"
+#include "InfoWindow.hpp"
+#include "MonoVideo.hpp"
+
+/****************************************************************
+			Main
+****************************************************************/
+
+// The hex keypad on the left of a QWERTY keyboard, 1234/QWER/ASDF/ZXCV standing in for 123C/456D/789E/A0BF
+static const sf::Keyboard::Key keypad[0x10] = {
+	sf::Keyboard::X, sf::Keyboard::Num1, sf::Keyboard::Num2, sf::Keyboard::Num3,
+	sf::Keyboard::Q, sf::Keyboard::W, sf::Keyboard::E, sf::Keyboard::A,
+	sf::Keyboard::S, sf::Keyboard::D, sf::Keyboard::Z, sf::Keyboard::C,
+	sf::Keyboard::Num4, sf::Keyboard::R, sf::Keyboard::F, sf::Keyboard::V
+};
+
+/*
+What the emulation thread hands the presentation thread: the screen as of the last frame due to be presented, and
+the info window's snapshot
+*/
+struct PresentSlot {
+	static const size_t MaxWords = 128 / 64 * 64; // The largest mode, 128x64
+
+	chp8::Framebuffer::VideoMode mode;
+	uint64_t words[MaxWords];
+	size_t wordCount;
+	uint64_t presentCount; // Frames the scheduler has asked to present so far, the screen is new when this changes
+	chp8::DebugSnapshot debug;
+};
+
+/*
+Input going the other way. Held states are only sent when they change
+*/
+struct Command {
+	enum Type : uint8_t { Keys, FastForward, Rewinding, ToggleTurbo, NextPresentInterval } type;
+	uint16_t value;
+};
+
+/*
+Emulation thread. Runs the scheduler against real time and publishes a slot whenever a frame is due to be presented
+or the info window is due a refresh, never waiting on the presentation thread
+*/
+static void runEmulation(chp8::Chip8& chip, chp8::Scheduler& scheduler, chp8::TripleBuffer<PresentSlot>& frames,
+	chp8::SpscRing<Command, 256>& input, std::atomic<bool>& running) {
+
+	static const int presentIntervals[] = { 1, 2, 4, 8, 0 };
+	int presentChoice = 0;
+	uint64_t presentCount = 0;
+	Command commands[64];
+	sf::Clock timer;
+	sf::Clock infoTimer;
+	while (running.load(std::memory_order_relaxed) && chip.isActive()) {
+		for (size_t n = input.pop(commands, 64); n != 0; n = input.pop(commands, 64)) {
+			for (size_t c = 0; c < n; c++) {
+				switch (commands[c].type) {
+				case Command::Keys:
+					scheduler.setKeys(commands[c].value);
+					break;
+				case Command::FastForward:
+					scheduler.setFastForward(commands[c].value != 0);
+					break;
+				case Command::Rewinding:
+					scheduler.setRewinding(commands[c].value != 0);
+					break;
+				case Command::ToggleTurbo:
+					scheduler.setTurbo(!scheduler.isTurbo());
+					break;
+				case Command::NextPresentInterval:
+					presentChoice = (presentChoice + 1) % (int)(sizeof(presentIntervals) / sizeof(presentIntervals[0]));
+					scheduler.setPresentInterval(presentIntervals[presentChoice]);
+					break;
+				}
+			}
+		}
+
+		sf::Time elapsed = timer.restart();
+		scheduler.advance(elapsed.asMicroseconds() * 1000);
+
+		bool present = scheduler.takePresentDue();
+		if (present)
+			presentCount++;
+		if (present || infoTimer.getElapsedTime() >= sf::milliseconds(500)) {
+			PresentSlot& slot = frames.write();
+			chp8::Framebuffer& framebuffer = chip.getFramebuffer();
+			slot.mode = framebuffer.getMode();
+			slot.wordCount = std::min(framebuffer.getWordCount(), PresentSlot::MaxWords);
+			std::copy(framebuffer.getWords(), framebuffer.getWords() + slot.wordCount, slot.words);
+			slot.presentCount = presentCount;
+			slot.debug.capture(chip, scheduler, elapsed.asSeconds());
+			frames.publish();
+			infoTimer.restart();
+		}
+
+		if (!scheduler.isUnthrottled())
+			sf::sleep(sf::microseconds(scheduler.getNanosUntilNextFrame() / 1000));
+	}
+	running.store(false, std::memory_order_relaxed);
+}
+
+int main(int argc, char* argv[]) {
+
+	// Determine the ROM
+	// TODO
+
+	// Create the chip, --quirks <chip8|schip|xochip> picks another interpreter's behaviour
+	chp8::Chip8 chip("chip8", "Nothing2");
+
+	// Timing: --cpu-hz <instructions per second>, --vip-timing to charge instructions their COSMAC VIP cycles instead,
+	// --turbo to run as fast as possible, --frameskip <n> to present every n-th frame (0 for none)
+	chp8::Scheduler scheduler(chip);
+
+	// The last 60 seconds, hold Backspace to play them backwards
+	chp8::Rewind rewind;
+	scheduler.setRewind(&rewind);
+
+	// Optionally trace every instruction, see tools/TraceDump.cpp. --record <file> logs the run for
+	// tools/Replay.cpp to play back, --seed <n> seeds the random numbers
+	chp8::Tracer tracer;
+	std::string recordPath;
+	uint32_t seed = chp8::DefaultRandomSeed;
+#if defined(CHP8_PROFILE)
+	// --profile <name> writes a hotspot report to <name>.txt and folded stacks to <name>.folded on exit
+	chp8::Profiler profiler;
+	std::string profilePath;
+#endif
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--trace" && i + 1 < argc && tracer.open(argv[i + 1]))
+			chip.setTracer(&tracer);
+		else if (arg == "--cpu-hz" && i + 1 < argc)
+			scheduler.setCpuFrequency((uint32_t)std::atoi(argv[i + 1]));
+		else if (arg == "--vip-timing")
+			scheduler.setCycleCosts(&chp8::vipCycleCosts);
+		else if (arg == "--turbo")
+			scheduler.setTurbo(true);
+		else if (arg == "--frameskip" && i + 1 < argc)
+			scheduler.setPresentInterval(std::atoi(argv[i + 1]));
+		else if (arg == "--record" && i + 1 < argc)
+			recordPath = argv[i + 1];
+		else if (arg == "--seed" && i + 1 < argc)
+			seed = (uint32_t)std::strtoul(argv[i + 1], nullptr, 0);
+		else if (arg == "--quirks" && i + 1 < argc) {
+			chp8::QuirkProfile profile;
+			if (chp8::findQuirkProfile(argv[i + 1], profile))
+				chip.setQuirkProfile(profile);
+			else
+				std::cout << "Unknown quirk profile " << argv[i + 1] << ", expected chip8, schip or xochip" << std::endl;
+		}
+#if defined(CHP8_PROFILE)
+		else if (arg == "--profile" && i + 1 < argc) {
+			profilePath = argv[i + 1];
+			chip.setProfiler(&profiler);
+		}
+#endif
+	}
+
+	// A recording can't contain a rewind, so recording turns rewinding off
+	chp8::InputLog inputLog;
+	if (!recordPath.empty()) {
+		scheduler.setRewind(nullptr);
+		scheduler.record(&inputLog, seed);
+	}
+	else {
+		chip.setSeed(seed);
+	}
+
+	// The emulation runs on its own thread, this one presents and pumps window events, so a display that blocks
+	// in vsync or the compositor never holds up the CPU. The windows only ever see published copies of the chip
+	chp8::TripleBuffer<PresentSlot> frames;
+	chp8::SpscRing<Command, 256> input;
+	std::atomic<bool> running{ true };
+	std::thread emulation(runEmulation, std::ref(chip), std::ref(scheduler), std::ref(frames), std::ref(input), std::ref(running));
+
+	chp8::Framebuffer shown;
+	chp8::MonoVideo video(shown);
+	chp8::InfoWindow info;
+
+	// Loop, until the chip errors or either window goes away. Hold Tab to fast forward, T toggles turbo and P
+	// cycles how often frames are presented. The info window also refreshes twice a second, so the speed stays
+	// visible when nothing is presented
+	uint64_t presented = 0;
+	uint16_t sentKeys = 0;
+	bool sentFastForward = false;
+	bool sentRewinding = false;
+	while (running.load(std::memory_order_relaxed) && video.isActive() && info.isActive()) {
+		video.pollEvents();
+		if (video.wasKeyPressed(sf::Keyboard::T))
+			input.push(Command{ Command::ToggleTurbo, 0 });
+		if (video.wasKeyPressed(sf::Keyboard::P))
+			input.push(Command{ Command::NextPresentInterval, 0 });
+
+		// A change that doesn't fit in the queue is sent again next time round
+		bool fastForward = video.isKeyHeld(sf::Keyboard::Tab);
+		if (fastForward != sentFastForward && input.push(Command{ Command::FastForward, fastForward }))
+			sentFastForward = fastForward;
+		bool rewinding = video.isKeyHeld(sf::Keyboard::Backspace);
+		if (rewinding != sentRewinding && input.push(Command{ Command::Rewinding, rewinding }))
+			sentRewinding = rewinding;
+
+		uint16_t keys = 0;
+		for (int k = 0; k < 0x10; k++) {
+			if (video.isKeyHeld(keypad[k]))
+				keys |= 1 << k;
+		}
+		if (keys != sentKeys && input.push(Command{ Command::Keys, keys }))
+			sentKeys = keys;
+
+		if (!frames.update()) {
+			sf::sleep(sf::milliseconds(1));
+			continue;
+		}
+
+		const PresentSlot& slot = frames.read();
+		if (slot.presentCount != presented) {
+			shown.setWords(slot.mode, slot.words, slot.wordCount);
+			video.present();
+			presented = slot.presentCount;
+		}
+		info.render(slot.debug);
+	}
+	running.store(false, std::memory_order_relaxed);
+	emulation.join();
+
+	if (!recordPath.empty())
+		inputLog.save(recordPath);
+
+#if defined(CHP8_PROFILE)
+	if (!profilePath.empty()) {
+		std::ofstream report(profilePath + ".txt");
+		profiler.writeReport(report);
+		std::ofstream folded(profilePath + ".folded");
+		profiler.writeFoldedStacks(folded);
+	}
+#endif
+
+}
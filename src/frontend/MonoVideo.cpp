@@ -0,0 +1,132 @@
+#include "MonoVideo.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <SFML/Graphics.hpp>
+
+using namespace chp8;
+
+/****************************************************************
+			MonoVideo Class
+****************************************************************/
+
+static uint32_t packColor(sf::Color color) {
+	// Texture memory order, R G B A
+	const sf::Uint8 bytes[4] = { color.r, color.g, color.b, color.a };
+	uint32_t packed;
+	std::memcpy(&packed, bytes, sizeof(packed));
+	return packed;
+}
+
+MonoVideo::MonoVideo(Framebuffer& source) : framebuffer(source), converter(packColor(activeColor), packColor(inactiveColor)) {
+	// Open the display
+	displayWindow.create(sf::VideoMode(512, 256), "CHP-8 MonoVideo Out");
+	displayWindow.setPosition(sf::Vector2i(300, 0));
+	// displayWindow.setFramerateLimit(60);
+
+	displayActive = true;
+	setVideoMode(framebuffer.getMode());
+}
+
+void MonoVideo::setVideoMode(Framebuffer::VideoMode vmode) {
+	mode = vmode;
+
+	std::cout << "Set MonoVideo vmode to " << mode.width << "x" << mode.height << std::endl;
+
+	converter.setVideoMode(mode);
+	videoTexture.create(mode.width, mode.height);
+
+	std::cout << "videoTexture " << videoTexture.getSize().x << "," << videoTexture.getSize().y << std::endl;
+
+	videoSprite.setTexture(videoTexture, true);
+	videoSprite.setScale(2.0f, 2.0f);
+	videoSprite.setPosition((displayWindow.getSize().x / 2.0f) - ((videoSprite.getScale().x * mode.width) / 2.0f), (displayWindow.getSize().y / 2.0f) - ((videoSprite.getScale().y * mode.height) / 2.0f));
+
+}
+
+MonoVideo::~MonoVideo() {
+	displayWindow.close();
+}
+
+void MonoVideo::pollEvents() {
+	std::memset(keysPressed, 0, sizeof(keysPressed));
+
+	sf::Event evt;
+	while (displayWindow.pollEvent(evt)) {
+		if (evt.type == sf::Event::Closed) {
+			// Close the window
+			displayWindow.close();
+		}
+		else if (evt.type == sf::Event::KeyPressed && evt.key.code >= 0 && evt.key.code < sf::Keyboard::KeyCount) {
+			keysPressed[evt.key.code] = !keysHeld[evt.key.code]; // Ignore key repeat
+			keysHeld[evt.key.code] = true;
+		}
+		else if (evt.type == sf::Event::KeyReleased && evt.key.code >= 0 && evt.key.code < sf::Keyboard::KeyCount) {
+			keysHeld[evt.key.code] = false;
+		}
+		else if (evt.type == sf::Event::LostFocus) {
+			// Releases go to whichever window has focus, so forget everything held
+			std::memset(keysHeld, 0, sizeof(keysHeld));
+		}
+	}
+
+	// Check the window is still open
+	if (!displayWindow.isOpen())
+		displayActive = false;
+}
+
+void MonoVideo::present() {
+	if (!displayActive)
+		return;
+
+	// Follow the framebuffer into a new mode, it marks every row dirty when it changes
+	Framebuffer::VideoMode current = framebuffer.getMode();
+	if (current.width != mode.width || current.height != mode.height)
+		setVideoMode(current);
+
+	// Only rows that changed get converted and uploaded, a frame with no changes uploads nothing
+	uint64_t dirty = framebuffer.takeDirtyRows();
+	if (dirty != 0)
+		uploadRows(dirty);
+
+	displayWindow.draw(videoSprite);
+
+	displayWindow.display();
+}
+
+bool MonoVideo::isKeyHeld(sf::Keyboard::Key key) {
+	return key >= 0 && key < sf::Keyboard::KeyCount && keysHeld[key];
+}
+
+bool MonoVideo::wasKeyPressed(sf::Keyboard::Key key) {
+	return key >= 0 && key < sf::Keyboard::KeyCount && keysPressed[key];
+}
+
+bool MonoVideo::isActive() {
+	return displayActive;
+}
+
+/****************************************************************
+			MonoVideo Class : Upload
+****************************************************************/
+
+void MonoVideo::uploadRows(uint64_t dirty) {
+	unsigned int height = (unsigned int)mode.height;
+
+	unsigned int y = 0;
+	while (dirty != 0 && y < height) {
+		// Skip to the start of the next run of dirty rows, then find its end
+		if (((dirty >> y) & 1) == 0) {
+			y++;
+			continue;
+		}
+		unsigned int first = y;
+		while (y < height && ((dirty >> y) & 1)) {
+			converter.convertRow(framebuffer, y);
+			y++;
+		}
+		dirty &= y >= 64 ? 0 : (~(uint64_t)0 << y);
+
+		videoTexture.update((const sf::Uint8*)converter.getRow(first), (unsigned int)mode.width, y - first, 0, first);
+	}
+}
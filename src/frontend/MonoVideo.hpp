@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Window/Keyboard.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+
+#include "../core/Framebuffer.hpp"
+#include "FrameConverter.hpp"
+
+namespace chp8 {
+
+	/****************************************************************
+			MonoVideo Class
+	****************************************************************/
+
+	/*
+	Displays a Framebuffer in its own window. It only observes the framebuffer, the emulator core never knows it
+	exists
+	*/
+	class MonoVideo {
+
+	public:
+		MonoVideo(Framebuffer& source);
+		~MonoVideo();
+
+		/*
+		Events are polled every loop iteration so the window stays responsive, frames are only drawn when the
+		scheduler says one is due
+		*/
+		void pollEvents();
+		void present();
+
+		bool isActive(); // Returns if the display is active
+
+		/*
+		Keyboard, as seen by this window
+		*/
+		bool isKeyHeld(sf::Keyboard::Key key);
+		bool wasKeyPressed(sf::Keyboard::Key key); // Pressed since the last pollEvents()
+
+	private:
+		Framebuffer& framebuffer;
+		Framebuffer::VideoMode mode; // The mode the texture was last built for
+		bool displayActive;
+
+		void setVideoMode(Framebuffer::VideoMode vmode);
+
+		sf::Texture videoTexture; // The video texture
+		sf::Sprite videoSprite;
+		sf::Color activeColor = sf::Color::White;
+		sf::Color inactiveColor = sf::Color::Black;
+
+		/*
+		Upload. Rows the framebuffer reports as dirty are converted to RGBA, then sent to the texture as one
+		sub-rectangle per run of consecutive dirty rows
+		*/
+		FrameConverter converter;
+		void uploadRows(uint64_t dirty);
+
+		sf::RenderWindow displayWindow;
+
+		bool keysHeld[sf::Keyboard::KeyCount] = {};
+		bool keysPressed[sf::Keyboard::KeyCount] = {};
+
+	};
+
+}
@@ -0,0 +1,100 @@
+#include "TextOverlay.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <SFML/Graphics/RenderStates.hpp>
+
+using namespace chp8;
+
+/****************************************************************
+			TextOverlay Class
+****************************************************************/
+
+void TextOverlay::setFont(const sf::Font& f, unsigned int characterSize) {
+	font = &f;
+	size = characterSize;
+
+	for (sf::Uint32 c = ' '; c <= '~'; c++)
+		font->getGlyph(c, size, false);
+
+	for (Field& field : fields)
+		buildField(field);
+}
+
+size_t TextOverlay::addField(float x, float y, size_t width, sf::Color color) {
+	Field field{ x, y, vertices.getVertexCount(), width, color, std::string() };
+	field.text.reserve(width);
+	vertices.resize(vertices.getVertexCount() + width * 6);
+	fields.push_back(field);
+	buildField(fields.back());
+	return fields.size() - 1;
+}
+
+void TextOverlay::setText(size_t field, const char* text) {
+	Field& f = fields[field];
+	size_t length = std::min(std::strlen(text), f.width);
+	if (f.text.size() == length && std::memcmp(f.text.data(), text, length) == 0)
+		return;
+
+	f.text.assign(text, length);
+	buildField(f);
+}
+
+void TextOverlay::setColor(size_t field, sf::Color color) {
+	Field& f = fields[field];
+	if (f.color == color)
+		return;
+
+	f.color = color;
+	for (size_t v = 0; v < f.width * 6; v++)
+		vertices[f.firstVertex + v].color = color;
+}
+
+void TextOverlay::draw(sf::RenderTarget& target) {
+	if (font == nullptr)
+		return;
+
+	sf::RenderStates states;
+	states.texture = &font->getTexture(size);
+	target.draw(vertices, states);
+}
+
+void TextOverlay::buildField(Field& field) {
+	// Quads are laid out the way sf::Text does it: from the baseline, one pixel of padding around each glyph
+	static const float Padding = 1.0f;
+
+	float x = field.x;
+	float baseline = field.y + size;
+	for (size_t slot = 0; slot < field.width; slot++) {
+		sf::Vertex* quad = &vertices[field.firstVertex + slot * 6];
+		const sf::Glyph* glyph = nullptr;
+		if (font != nullptr && slot < field.text.size())
+			glyph = &font->getGlyph((unsigned char)field.text[slot], size, false);
+
+		// Unused slots and blanks collapse to nothing
+		if (glyph == nullptr || glyph->bounds.width == 0) {
+			for (int v = 0; v < 6; v++)
+				quad[v] = sf::Vertex(sf::Vector2f(field.x, field.y), field.color);
+			if (glyph != nullptr)
+				x += glyph->advance;
+			continue;
+		}
+
+		float left = x + glyph->bounds.left - Padding;
+		float top = baseline + glyph->bounds.top - Padding;
+		float right = x + glyph->bounds.left + glyph->bounds.width + Padding;
+		float bottom = baseline + glyph->bounds.top + glyph->bounds.height + Padding;
+		float u1 = glyph->textureRect.left - Padding;
+		float v1 = glyph->textureRect.top - Padding;
+		float u2 = glyph->textureRect.left + glyph->textureRect.width + Padding;
+		float v2 = glyph->textureRect.top + glyph->textureRect.height + Padding;
+
+		quad[0] = sf::Vertex(sf::Vector2f(left, top), field.color, sf::Vector2f(u1, v1));
+		quad[1] = sf::Vertex(sf::Vector2f(right, top), field.color, sf::Vector2f(u2, v1));
+		quad[2] = sf::Vertex(sf::Vector2f(left, bottom), field.color, sf::Vector2f(u1, v2));
+		quad[3] = sf::Vertex(sf::Vector2f(left, bottom), field.color, sf::Vector2f(u1, v2));
+		quad[4] = sf::Vertex(sf::Vector2f(right, top), field.color, sf::Vector2f(u2, v1));
+		quad[5] = sf::Vertex(sf::Vector2f(right, bottom), field.color, sf::Vector2f(u2, v2));
+		x += glyph->advance;
+	}
+}
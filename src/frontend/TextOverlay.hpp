@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+
+namespace chp8 {
+
+	/****************************************************************
+			TextOverlay Class
+	****************************************************************/
+
+	/*
+	Retained text panel. Each field has a fixed position and a fixed number of glyph slots in one shared vertex
+	array. Setting a field to the text it already shows costs a compare, and only a field whose text or colour
+	changed has its quads rebuilt. The whole panel is one draw call.
+
+	Printable ASCII is rendered into the font's texture up front, so the texture never grows under glyphs that
+	have already been placed
+	*/
+	class TextOverlay {
+
+	public:
+		void setFont(const sf::Font& f, unsigned int characterSize);
+
+		/*
+		Returns the field's index. Text longer than width is cut off
+		*/
+		size_t addField(float x, float y, size_t width, sf::Color color = sf::Color::White);
+
+		void setText(size_t field, const char* text);
+		void setColor(size_t field, sf::Color color);
+
+		void draw(sf::RenderTarget& target);
+
+	private:
+		const sf::Font* font = nullptr;
+		unsigned int size = 0;
+
+		struct Field {
+			float x;
+			float y;
+			size_t firstVertex;
+			size_t width; // Glyph slots
+			sf::Color color;
+			std::string text;
+		};
+		std::vector<Field> fields;
+		sf::VertexArray vertices{ sf::Triangles }; // Six per glyph slot
+
+		void buildField(Field& field);
+
+	};
+
+}
@@ -0,0 +1,467 @@
+/*
+
+CHP-8 Batch Runner (chp8-batch)
+
+Runs many headless CHP-8 instances across every core and records where each one ended up. The job list is a text
+file with one job per line, blank lines and lines starting with # are ignored:
+
+	<rom path>  <input script path, or - for none>  <cycle budget>
+
+An input script holds "<cycle> <key mask>" lines in ascending cycle order. From that cycle on, the keypad state is
+the hexadecimal mask, bit n for key n.
+
+Results are written column by column: a FileHeader, then for every column a ColumnHeader followed by one value per
+job, in job list order. With --csv they are written as one line per job instead.
+
+Usage: chp8-batch <job list> <results file> [--threads n] [--engine interpreter|threaded|recompiled|differential] [--csv]
+	[--quirks chip8|schip|xochip]
+
+--quirks picks the profile every job runs with, default profile: chip8 (COSMAC VIP), see Quirks.hpp.
+
+--engine differential checks every recompiled block against the interpreter. A job that hits a mismatch stops there
+and is reported by ROM and PC, and the run exits 1.
+
+Each worker owns one Chip8 and resets it between jobs, ROMs and scripts are read once up front and shared
+read-only, and every job writes only its own result slot, so workers share nothing mutable except the work queues.
+
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/core/CHP-8.hpp"
+#include "../src/core/Quirks.hpp"
+
+using namespace chp8;
+
+/****************************************************************
+		Jobs
+****************************************************************/
+
+struct InputEvent {
+	uint64_t cycle;
+	uint16_t keys;
+};
+
+struct Job {
+	uint32_t rom;
+	uint32_t script; // NoScript if the job runs without input
+	uint64_t budget;
+};
+
+static const uint32_t NoScript = UINT32_MAX;
+
+/*
+Loaded once and then only read by the workers
+*/
+struct JobSet {
+	std::vector<Job> jobs;
+	std::vector<std::vector<uint8_t>> roms;
+	std::vector<std::string> romPaths;
+	std::vector<std::vector<InputEvent>> scripts;
+};
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& out) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+	out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return true;
+}
+
+static bool readScript(const std::string& path, std::vector<InputEvent>& out) {
+	std::ifstream file(path);
+	if (!file)
+		return false;
+
+	std::string line;
+	while (std::getline(file, line)) {
+		if (line.empty() || line[0] == '#')
+			continue;
+		std::istringstream fields(line);
+		InputEvent event;
+		std::string mask;
+		if (!(fields >> event.cycle >> mask))
+			continue;
+		event.keys = (uint16_t)std::strtoul(mask.c_str(), nullptr, 16);
+		out.push_back(event);
+	}
+	return true;
+}
+
+static bool loadJobs(const char* path, JobSet& set) {
+	std::ifstream file(path);
+	if (!file) {
+		std::cout << "Failed to open " << path << std::endl;
+		return false;
+	}
+
+	std::map<std::string, uint32_t> romIndex;
+	std::map<std::string, uint32_t> scriptIndex;
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line)) {
+		lineNumber++;
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		std::istringstream fields(line);
+		std::string romPath, scriptPath;
+		Job job;
+		if (!(fields >> romPath >> scriptPath >> job.budget)) {
+			std::cout << path << ":" << lineNumber << ": expected <rom> <input script> <cycles>" << std::endl;
+			return false;
+		}
+
+		auto rom = romIndex.find(romPath);
+		if (rom == romIndex.end()) {
+			set.roms.emplace_back();
+			set.romPaths.push_back(romPath);
+			if (!readFile(romPath, set.roms.back())) {
+				std::cout << path << ":" << lineNumber << ": failed to read " << romPath << std::endl;
+				return false;
+			}
+			rom = romIndex.emplace(romPath, (uint32_t)set.roms.size() - 1).first;
+		}
+		job.rom = rom->second;
+
+		job.script = NoScript;
+		if (scriptPath != "-") {
+			auto script = scriptIndex.find(scriptPath);
+			if (script == scriptIndex.end()) {
+				set.scripts.emplace_back();
+				if (!readScript(scriptPath, set.scripts.back())) {
+					std::cout << path << ":" << lineNumber << ": failed to read " << scriptPath << std::endl;
+					return false;
+				}
+				script = scriptIndex.emplace(scriptPath, (uint32_t)set.scripts.size() - 1).first;
+			}
+			job.script = script->second;
+		}
+
+		set.jobs.push_back(job);
+	}
+	return true;
+}
+
+/****************************************************************
+		Results
+****************************************************************/
+
+/*
+One per job, written only by the worker that ran it. Padded to a cache line so neighbouring jobs finishing on
+different cores don't contend
+*/
+struct alignas(64) Result {
+	uint64_t hash; // Framebuffer::hash() at the end of the run
+	uint64_t cycles; // Instructions executed
+	uint16_t pc;
+	uint16_t i;
+	uint8_t sp;
+	uint8_t error; // Chip8::Chip8Error
+	uint8_t v[0x10];
+	uint16_t errorPC; // Reported, not written
+};
+
+struct FileHeader {
+	char magic[8]; // "CHP8RES"
+	uint32_t version;
+	uint32_t columns;
+	uint64_t rows;
+};
+
+struct ColumnHeader {
+	char name[16]; // Zero padded
+	uint32_t elementSize; // Bytes per value, values are little endian unsigned integers
+	uint32_t reserved;
+};
+
+template <typename T, typename Get> static void writeColumn(std::ofstream& out, const char* name, const std::vector<Result>& results, Get get) {
+	ColumnHeader header{};
+	std::strncpy(header.name, name, sizeof(header.name));
+	header.elementSize = sizeof(T);
+	out.write((const char*)&header, sizeof(header));
+
+	std::vector<T> column(results.size());
+	for (size_t i = 0; i < results.size(); i++) {
+		column[i] = get(results[i]);
+	}
+	out.write((const char*)column.data(), column.size() * sizeof(T));
+}
+
+static bool writeColumnar(const char* path, const std::vector<Result>& results) {
+	std::ofstream out(path, std::ios::binary);
+	if (!out)
+		return false;
+
+	FileHeader header{};
+	std::memcpy(header.magic, "CHP8RES", 8);
+	header.version = 1;
+	header.columns = 6 + 0x10;
+	header.rows = results.size();
+	out.write((const char*)&header, sizeof(header));
+
+	writeColumn<uint64_t>(out, "hash", results, [](const Result& r) { return r.hash; });
+	writeColumn<uint64_t>(out, "cycles", results, [](const Result& r) { return r.cycles; });
+	writeColumn<uint16_t>(out, "pc", results, [](const Result& r) { return r.pc; });
+	writeColumn<uint16_t>(out, "i", results, [](const Result& r) { return r.i; });
+	writeColumn<uint8_t>(out, "sp", results, [](const Result& r) { return r.sp; });
+	writeColumn<uint8_t>(out, "error", results, [](const Result& r) { return r.error; });
+	for (int x = 0; x < 0x10; x++) {
+		char name[4];
+		std::snprintf(name, sizeof(name), "v%X", x);
+		writeColumn<uint8_t>(out, name, results, [x](const Result& r) { return r.v[x]; });
+	}
+	return (bool)out;
+}
+
+static bool writeCsv(const char* path, const std::vector<Result>& results) {
+	FILE* out = std::fopen(path, "w");
+	if (out == nullptr)
+		return false;
+
+	std::fprintf(out, "job,hash,cycles,pc,i,sp,error");
+	for (int x = 0; x < 0x10; x++) {
+		std::fprintf(out, ",v%X", x);
+	}
+	std::fprintf(out, "\n");
+
+	for (size_t j = 0; j < results.size(); j++) {
+		const Result& r = results[j];
+		std::fprintf(out, "%zu,%016llx,%llu,%03x,%03x,%u,%u", j, (unsigned long long)r.hash, (unsigned long long)r.cycles, r.pc, r.i, r.sp, r.error);
+		for (int x = 0; x < 0x10; x++) {
+			std::fprintf(out, ",%u", r.v[x]);
+		}
+		std::fprintf(out, "\n");
+	}
+	return std::fclose(out) == 0;
+}
+
+/****************************************************************
+		Work stealing
+****************************************************************/
+
+/*
+Jobs are dealt out to workers as contiguous index ranges, packed into one word as begin << 32 | end. The owner takes
+jobs from the front, a worker that runs dry takes the back half of someone else's range. Both sides only ever
+compare-and-swap the word, so there are no locks and nothing to allocate once the pool is running
+*/
+struct alignas(64) WorkRange {
+	std::atomic<uint64_t> range{ 0 };
+
+	static uint64_t pack(uint32_t begin, uint32_t end) { return (uint64_t)begin << 32 | end; }
+	static uint32_t begin(uint64_t r) { return (uint32_t)(r >> 32); }
+	static uint32_t end(uint64_t r) { return (uint32_t)r; }
+
+	bool take(uint32_t& job) {
+		uint64_t r = range.load(std::memory_order_relaxed);
+		while (begin(r) < end(r)) {
+			if (range.compare_exchange_weak(r, pack(begin(r) + 1, end(r)), std::memory_order_acquire, std::memory_order_relaxed)) {
+				job = begin(r);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Moves the back half of victim's range into this (empty) one. Only the owner stores into its own range
+	bool stealFrom(WorkRange& victim) {
+		uint64_t r = victim.range.load(std::memory_order_relaxed);
+		while (begin(r) < end(r)) {
+			uint32_t count = end(r) - begin(r);
+			uint32_t split = end(r) - (count + 1) / 2;
+			if (victim.range.compare_exchange_weak(r, pack(begin(r), split), std::memory_order_acquire, std::memory_order_relaxed)) {
+				range.store(pack(split, end(r)), std::memory_order_release);
+				return true;
+			}
+		}
+		return false;
+	}
+};
+
+/****************************************************************
+		Running
+****************************************************************/
+
+static void runJob(Chip8& chip, const JobSet& set, const Job& job, Result& result) {
+	static const uint64_t Slice = 0x10000; // Instructions per execute() call between input and error checks
+
+	chip.reset();
+	const std::vector<uint8_t>& rom = set.roms[job.rom];
+	chip.loadProgram(rom.data(), rom.size());
+
+	const InputEvent* event = nullptr;
+	const InputEvent* lastEvent = nullptr;
+	if (job.script != NoScript && !set.scripts[job.script].empty()) {
+		event = set.scripts[job.script].data();
+		lastEvent = event + set.scripts[job.script].size();
+	}
+
+	uint64_t cycles = 0;
+	while (cycles < job.budget && chip.getError() == Chip8::None) {
+		while (event != lastEvent && event->cycle <= cycles) {
+			chip.setKeys(event->keys);
+			event++;
+		}
+
+		uint64_t until = std::min(job.budget, cycles + Slice);
+		if (event != lastEvent)
+			until = std::min(until, event->cycle);
+
+		int ran = chip.execute((int)(until - cycles));
+		if (ran == 0)
+			break;
+		cycles += ran;
+	}
+
+	result.hash = chip.getFramebuffer().hash();
+	result.cycles = cycles;
+	result.pc = chip.getPC();
+	result.i = chip.getI();
+	result.sp = chip.getSP();
+	result.error = (uint8_t)chip.getError();
+	result.errorPC = chip.getErrorPC();
+	for (uint8_t x = 0; x < 0x10; x++) {
+		result.v[x] = chip.getRegister(x);
+	}
+}
+
+static void runWorker(unsigned int self, std::vector<WorkRange>& queues, const JobSet& set, Chip8::Engine engine, QuirkProfile profile,
+	std::vector<Result>& results) {
+	// Constructed once per worker, everything after this reuses its memory
+	Chip8 chip("chip8", "");
+	chip.setEngine(engine);
+	chip.setQuirkProfile(profile);
+
+	unsigned int workers = (unsigned int)queues.size();
+	for (;;) {
+		uint32_t job;
+		if (queues[self].take(job)) {
+			runJob(chip, set, set.jobs[job], results[job]);
+			continue;
+		}
+
+		// Out of work, go looking for some starting with the next worker along
+		bool stole = false;
+		for (unsigned int n = 1; n < workers && !stole; n++) {
+			stole = queues[self].stealFrom(queues[(self + n) % workers]);
+		}
+		if (!stole)
+			return;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		std::cout << "Usage: " << argv[0] << " <job list> <results file> [--threads n] [--engine interpreter|threaded|recompiled|differential] [--csv] "
+			"[--quirks chip8|schip|xochip]" << std::endl;
+		return 1;
+	}
+
+	unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+	Chip8::Engine engine = Chip8::Threaded;
+	QuirkProfile profile = Cosmac;
+	bool csv = false;
+	for (int a = 3; a < argc; a++) {
+		std::string arg = argv[a];
+		if (arg == "--threads" && a + 1 < argc) {
+			threads = std::max(1, std::atoi(argv[++a]));
+		}
+		else if (arg == "--engine" && a + 1 < argc) {
+			std::string name = argv[++a];
+			if (name == "interpreter")
+				engine = Chip8::Interpreter;
+			else if (name == "threaded")
+				engine = Chip8::Threaded;
+			else if (name == "recompiled")
+				engine = Chip8::Recompiled;
+			else if (name == "differential")
+				engine = Chip8::RecompiledDifferential;
+			else {
+				std::cout << "Unknown engine " << name << std::endl;
+				return 1;
+			}
+		}
+		else if (arg == "--csv") {
+			csv = true;
+		}
+		else if (arg == "--quirks" && a + 1 < argc) {
+			if (!findQuirkProfile(argv[++a], profile)) {
+				std::cout << "Unknown quirk profile " << argv[a] << ", expected chip8, schip or xochip" << std::endl;
+				return 1;
+			}
+		}
+		else {
+			std::cout << "Unknown option " << arg << std::endl;
+			return 1;
+		}
+	}
+
+	JobSet set;
+	if (!loadJobs(argv[1], set))
+		return 1;
+	if (set.jobs.empty()) {
+		std::cout << "No jobs in " << argv[1] << std::endl;
+		return 1;
+	}
+	threads = std::min<size_t>(threads, set.jobs.size());
+
+	std::vector<Result> results(set.jobs.size());
+
+	// Deal the jobs out evenly, stealing evens out whatever imbalance their budgets cause
+	std::vector<WorkRange> queues(threads);
+	uint32_t jobCount = (uint32_t)set.jobs.size();
+	for (unsigned int t = 0; t < threads; t++) {
+		uint32_t begin = (uint32_t)((uint64_t)jobCount * t / threads);
+		uint32_t end = (uint32_t)((uint64_t)jobCount * (t + 1) / threads);
+		queues[t].range.store(WorkRange::pack(begin, end), std::memory_order_relaxed);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> pool;
+	for (unsigned int t = 1; t < threads; t++) {
+		pool.emplace_back(runWorker, t, std::ref(queues), std::cref(set), engine, profile, std::ref(results));
+	}
+	runWorker(0, queues, set, engine, profile, results);
+	for (std::thread& worker : pool) {
+		worker.join();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	uint64_t totalCycles = 0;
+	size_t failed = 0, mismatched = 0;
+	for (size_t j = 0; j < results.size(); j++) {
+		const Result& r = results[j];
+		totalCycles += r.cycles;
+		if (r.error != Chip8::None)
+			failed++;
+		if (r.error == Chip8::RecompilerMismatch) {
+			std::cout << "Job " << j << " (" << set.romPaths[set.jobs[j].rom] << "): recompiler mismatch in the block at PC "
+				<< std::hex << r.errorPC << std::dec << std::endl;
+			mismatched++;
+		}
+	}
+
+	bool written = csv ? writeCsv(argv[2], results) : writeColumnar(argv[2], results);
+	if (!written) {
+		std::cout << "Failed to write " << argv[2] << std::endl;
+		return 1;
+	}
+
+	std::cout << set.jobs.size() << " jobs on " << threads << " threads in " << seconds << "s, "
+		<< totalCycles / seconds / 1e6 << "M instructions/s, " << failed << " stopped on an error" << std::endl;
+	return mismatched == 0 ? 0 : 1;
+}
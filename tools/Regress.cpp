@@ -0,0 +1,467 @@
+/*
+
+CHP-8 Regression Harness (chp8-regress)
+
+Runs a corpus of ROMs headless, each for a fixed number of instructions with scripted input, hashes the framebuffer
+at regular checkpoints and checks the hashes and the runtime against a golden file. The corpus is a text file with
+one ROM per line, blank lines and lines starting with # are ignored:
+
+	<name>  <rom path>  <input script path, or - for none>  <instructions>  <checkpoint every n instructions>  [quirks]
+
+The optional last field is the quirk profile the ROM runs with (chip8, schip or xochip, see Quirks.hpp), --quirks
+otherwise, default profile: chip8 (COSMAC VIP). Golden hashes only hold for the profile they were recorded with.
+
+Input scripts are the ones chp8-batch takes, "<cycle> <key mask>" lines in ascending cycle order. The golden file is
+plain text so changes to it read well in a diff:
+
+	hash <name> <cycle> <framebuffer hash>
+	time <name> <ns per instruction>
+
+Without --update, a ROM fails if any checkpoint hash differs from (or is missing in) the golden file, and is flagged
+as slower if its ns per instruction is more than --threshold percent (default 10) over the golden time. With
+--update the golden file is rewritten from this run. ROMs run in parallel, one Chip8 per worker; timings are the best
+of --runs runs, and are steadier with --threads 1 when the corpus is small enough to afford it.
+
+--no-timing leaves the runtime out: nothing is flagged as slower, and --update writes no time lines. Golden times
+only mean something on the machine that measured them, so checks run anywhere else (tools/regress/) use it.
+
+--engine differential runs every recompiled block on the interpreter too and fails a ROM at the first block whose
+result differs, so a corpus run doubles as a check of the recompiler. Timings are meaningless in that mode.
+
+Usage: chp8-regress <corpus> <golden file> [--update] [--threads n] [--runs n] [--threshold percent] [--no-timing]
+	[--engine interpreter|threaded|recompiled|differential] [--quirks chip8|schip|xochip]
+
+Exits 0 if every ROM matched and none got slower, 1 otherwise.
+
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/core/CHP-8.hpp"
+#include "../src/core/Quirks.hpp"
+
+using namespace chp8;
+
+/****************************************************************
+		Corpus
+****************************************************************/
+
+struct InputEvent {
+	uint64_t cycle;
+	uint16_t keys;
+};
+
+struct Test {
+	std::string name;
+	std::vector<uint8_t> rom;
+	std::vector<InputEvent> script;
+	uint64_t budget;
+	uint64_t interval; // Instructions between checkpoints
+	QuirkProfile profile;
+};
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& out) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+	out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return true;
+}
+
+static bool readScript(const std::string& path, std::vector<InputEvent>& out) {
+	std::ifstream file(path);
+	if (!file)
+		return false;
+
+	std::string line;
+	while (std::getline(file, line)) {
+		if (line.empty() || line[0] == '#')
+			continue;
+		std::istringstream fields(line);
+		InputEvent event;
+		std::string mask;
+		if (!(fields >> event.cycle >> mask))
+			continue;
+		event.keys = (uint16_t)std::strtoul(mask.c_str(), nullptr, 16);
+		out.push_back(event);
+	}
+	return true;
+}
+
+static bool loadCorpus(const char* path, QuirkProfile defaultProfile, std::vector<Test>& tests) {
+	std::ifstream file(path);
+	if (!file) {
+		std::cout << "Failed to open " << path << std::endl;
+		return false;
+	}
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line)) {
+		lineNumber++;
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		std::istringstream fields(line);
+		std::string romPath, scriptPath;
+		Test test;
+		if (!(fields >> test.name >> romPath >> scriptPath >> test.budget >> test.interval) || test.interval == 0) {
+			std::cout << path << ":" << lineNumber << ": expected <name> <rom> <input script> <instructions> <checkpoint interval> [quirks]" << std::endl;
+			return false;
+		}
+		std::string profileName;
+		test.profile = defaultProfile;
+		if (fields >> profileName && !findQuirkProfile(profileName, test.profile)) {
+			std::cout << path << ":" << lineNumber << ": unknown quirk profile " << profileName << std::endl;
+			return false;
+		}
+		if (!readFile(romPath, test.rom)) {
+			std::cout << path << ":" << lineNumber << ": failed to read " << romPath << std::endl;
+			return false;
+		}
+		if (scriptPath != "-" && !readScript(scriptPath, test.script)) {
+			std::cout << path << ":" << lineNumber << ": failed to read " << scriptPath << std::endl;
+			return false;
+		}
+		tests.push_back(std::move(test));
+	}
+	return true;
+}
+
+/****************************************************************
+		Golden file
+****************************************************************/
+
+struct Golden {
+	std::map<std::string, std::map<uint64_t, uint64_t>> hashes; // Name to cycle to hash
+	std::map<std::string, double> times; // Name to ns per instruction
+};
+
+static bool readGolden(const char* path, Golden& golden) {
+	std::ifstream file(path);
+	if (!file)
+		return false;
+
+	std::string line;
+	while (std::getline(file, line)) {
+		if (line.empty() || line[0] == '#')
+			continue;
+		std::istringstream fields(line);
+		std::string kind, name;
+		fields >> kind >> name;
+		if (kind == "hash") {
+			uint64_t cycle;
+			std::string hash;
+			if (fields >> cycle >> hash)
+				golden.hashes[name][cycle] = std::strtoull(hash.c_str(), nullptr, 16);
+		}
+		else if (kind == "time") {
+			double ns;
+			if (fields >> ns)
+				golden.times[name] = ns;
+		}
+	}
+	return true;
+}
+
+/****************************************************************
+		Running
+****************************************************************/
+
+struct Checkpoint {
+	uint64_t cycle;
+	uint64_t hash;
+};
+
+struct Result {
+	std::vector<Checkpoint> checkpoints;
+	uint64_t cycles; // Instructions executed, short of the budget if the ROM stopped on an error
+	Chip8::Chip8Error error;
+	uint16_t errorPC;
+	double nsPerInstruction; // Best of the runs
+	bool deterministic; // Every run produced the same checkpoints
+};
+
+/*
+One run of a test from reset, in execute() slices that end at input changes and checkpoints
+*/
+static void runTest(Chip8& chip, const Test& test, Result& result) {
+	chip.setQuirkProfile(test.profile);
+	chip.reset();
+	chip.loadProgram(test.rom.data(), test.rom.size());
+	result.checkpoints.clear();
+
+	const InputEvent* event = test.script.data();
+	const InputEvent* lastEvent = event + test.script.size();
+
+	uint64_t cycles = 0;
+	uint64_t nextCheckpoint = std::min(test.interval, test.budget);
+	while (cycles < test.budget && chip.getError() == Chip8::None) {
+		while (event != lastEvent && event->cycle <= cycles) {
+			chip.setKeys(event->keys);
+			event++;
+		}
+
+		uint64_t until = nextCheckpoint;
+		if (event != lastEvent)
+			until = std::min(until, event->cycle);
+
+		int ran = chip.execute((int)std::min<uint64_t>(until - cycles, INT32_MAX));
+		if (ran == 0)
+			break;
+		cycles += ran;
+
+		if (cycles == nextCheckpoint) {
+			result.checkpoints.push_back(Checkpoint{ cycles, chip.getFramebuffer().hash() });
+			nextCheckpoint = std::min(nextCheckpoint + test.interval, test.budget);
+		}
+	}
+
+	// A ROM that stopped early still gets the screen it stopped on checked
+	if (result.checkpoints.empty() || result.checkpoints.back().cycle != cycles)
+		result.checkpoints.push_back(Checkpoint{ cycles, chip.getFramebuffer().hash() });
+	result.cycles = cycles;
+	result.error = chip.getError();
+	result.errorPC = chip.getErrorPC();
+}
+
+static void runWorker(std::atomic<size_t>& next, const std::vector<Test>& tests, std::vector<Result>& results, Chip8::Engine engine, int runs) {
+	Chip8 chip("chip8", "");
+	chip.setEngine(engine);
+
+	for (size_t t = next.fetch_add(1); t < tests.size(); t = next.fetch_add(1)) {
+		Result& result = results[t];
+		Result run;
+		for (int r = 0; r < runs; r++) {
+			auto start = std::chrono::steady_clock::now();
+			runTest(chip, tests[t], run);
+			double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+			double nsPerInstruction = run.cycles != 0 ? ns / run.cycles : 0.0;
+
+			if (r == 0) {
+				result = run;
+				result.deterministic = true;
+			}
+			else {
+				result.nsPerInstruction = std::min(result.nsPerInstruction, nsPerInstruction);
+				result.deterministic = result.deterministic && run.cycles == result.cycles && run.checkpoints.size() == result.checkpoints.size()
+					&& std::equal(run.checkpoints.begin(), run.checkpoints.end(), result.checkpoints.begin(),
+						[](const Checkpoint& a, const Checkpoint& b) { return a.cycle == b.cycle && a.hash == b.hash; });
+				continue;
+			}
+			result.nsPerInstruction = nsPerInstruction;
+		}
+	}
+}
+
+/****************************************************************
+		Reporting
+****************************************************************/
+
+/*
+Returns false and describes the first difference if the result doesn't match the golden hashes
+*/
+static bool compareHashes(const Test& test, const Result& result, const Golden& golden, std::string& difference) {
+	auto expected = golden.hashes.find(test.name);
+	if (expected == golden.hashes.end()) {
+		difference = "no golden hashes";
+		return false;
+	}
+
+	char text[128];
+	for (const Checkpoint& checkpoint : result.checkpoints) {
+		auto hash = expected->second.find(checkpoint.cycle);
+		if (hash == expected->second.end()) {
+			std::snprintf(text, sizeof(text), "no golden hash at cycle %llu", (unsigned long long)checkpoint.cycle);
+			difference = text;
+			return false;
+		}
+		if (hash->second != checkpoint.hash) {
+			std::snprintf(text, sizeof(text), "differs at cycle %llu (%016llx, expected %016llx)", (unsigned long long)checkpoint.cycle,
+				(unsigned long long)checkpoint.hash, (unsigned long long)hash->second);
+			difference = text;
+			return false;
+		}
+	}
+	if (expected->second.size() != result.checkpoints.size()) {
+		std::snprintf(text, sizeof(text), "%zu checkpoints, expected %zu", result.checkpoints.size(), expected->second.size());
+		difference = text;
+		return false;
+	}
+	return true;
+}
+
+static bool writeGolden(const char* path, const std::vector<Test>& tests, const std::vector<Result>& results, bool times) {
+	FILE* out = std::fopen(path, "w");
+	if (out == nullptr)
+		return false;
+
+	std::fprintf(out, "# chp8-regress golden file\n");
+	for (size_t t = 0; t < tests.size(); t++) {
+		if (times)
+			std::fprintf(out, "time %s %.3f\n", tests[t].name.c_str(), results[t].nsPerInstruction);
+		for (const Checkpoint& checkpoint : results[t].checkpoints) {
+			std::fprintf(out, "hash %s %llu %016llx\n", tests[t].name.c_str(), (unsigned long long)checkpoint.cycle, (unsigned long long)checkpoint.hash);
+		}
+	}
+	return std::fclose(out) == 0;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		std::cout << "Usage: " << argv[0] << " <corpus> <golden file> [--update] [--threads n] [--runs n] [--threshold percent] [--no-timing] "
+			"[--engine interpreter|threaded|recompiled|differential] [--quirks chip8|schip|xochip]" << std::endl;
+		return 1;
+	}
+
+	bool update = false;
+	unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+	int runs = 1;
+	double threshold = 10.0;
+	bool checkTimes = true;
+	Chip8::Engine engine = Chip8::Threaded;
+	QuirkProfile profile = Cosmac;
+	for (int a = 3; a < argc; a++) {
+		std::string arg = argv[a];
+		if (arg == "--update") {
+			update = true;
+		}
+		else if (arg == "--threads" && a + 1 < argc) {
+			threads = std::max(1, std::atoi(argv[++a]));
+		}
+		else if (arg == "--runs" && a + 1 < argc) {
+			runs = std::max(1, std::atoi(argv[++a]));
+		}
+		else if (arg == "--threshold" && a + 1 < argc) {
+			threshold = std::atof(argv[++a]);
+		}
+		else if (arg == "--no-timing") {
+			checkTimes = false;
+		}
+		else if (arg == "--quirks" && a + 1 < argc) {
+			if (!findQuirkProfile(argv[++a], profile)) {
+				std::cout << "Unknown quirk profile " << argv[a] << ", expected chip8, schip or xochip" << std::endl;
+				return 1;
+			}
+		}
+		else if (arg == "--engine" && a + 1 < argc) {
+			std::string name = argv[++a];
+			if (name == "interpreter")
+				engine = Chip8::Interpreter;
+			else if (name == "threaded")
+				engine = Chip8::Threaded;
+			else if (name == "recompiled")
+				engine = Chip8::Recompiled;
+			else if (name == "differential")
+				engine = Chip8::RecompiledDifferential;
+			else {
+				std::cout << "Unknown engine " << name << std::endl;
+				return 1;
+			}
+		}
+		else {
+			std::cout << "Unknown option " << arg << std::endl;
+			return 1;
+		}
+	}
+
+	std::vector<Test> tests;
+	if (!loadCorpus(argv[1], profile, tests))
+		return 1;
+	if (tests.empty()) {
+		std::cout << "No ROMs in " << argv[1] << std::endl;
+		return 1;
+	}
+
+	Golden golden;
+	if (!update && !readGolden(argv[2], golden)) {
+		std::cout << "Failed to read " << argv[2] << ", run with --update to create it" << std::endl;
+		return 1;
+	}
+
+	// Workers take the next ROM as they finish one. ROM runtimes vary a lot, so this is all the balancing needed
+	threads = std::min<size_t>(threads, tests.size());
+	std::vector<Result> results(tests.size());
+	std::atomic<size_t> next{ 0 };
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> pool;
+	for (unsigned int t = 1; t < threads; t++) {
+		pool.emplace_back(runWorker, std::ref(next), std::cref(tests), std::ref(results), engine, runs);
+	}
+	runWorker(next, tests, results, engine, runs);
+	for (std::thread& worker : pool) {
+		worker.join();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// A mismatch means the recompiler is wrong, whatever the hashes say, and its hashes mustn't become golden
+	size_t mismatched = 0;
+	for (size_t t = 0; t < tests.size(); t++) {
+		if (results[t].error == Chip8::RecompilerMismatch) {
+			std::cout << tests[t].name << ": recompiler mismatch in the block at PC " << std::hex << results[t].errorPC << std::dec << std::endl;
+			mismatched++;
+		}
+	}
+	if (mismatched != 0) {
+		std::cout << mismatched << " of " << tests.size() << " ROMs hit a recompiler mismatch" << std::endl;
+		return 1;
+	}
+
+	if (update) {
+		if (!writeGolden(argv[2], tests, results, checkTimes)) {
+			std::cout << "Failed to write " << argv[2] << std::endl;
+			return 1;
+		}
+		std::cout << "Wrote golden hashes" << (checkTimes ? " and times" : "") << " for " << tests.size() << " ROMs to " << argv[2] << std::endl;
+		return 0;
+	}
+
+	size_t differing = 0, slower = 0;
+	char line[256];
+	for (size_t t = 0; t < tests.size(); t++) {
+		const Test& test = tests[t];
+		const Result& result = results[t];
+
+		std::string status = "ok";
+		std::string difference;
+		if (!compareHashes(test, result, golden, difference)) {
+			status = "DIFF " + difference;
+			differing++;
+		}
+		else if (!result.deterministic) {
+			status = "DIFF between runs";
+			differing++;
+		}
+
+		std::string timing = checkTimes ? "no golden time" : "not checked";
+		auto time = golden.times.find(test.name);
+		if (checkTimes && time != golden.times.end() && time->second > 0) {
+			double change = (result.nsPerInstruction / time->second - 1.0) * 100.0;
+			char text[64];
+			std::snprintf(text, sizeof(text), "%+.1f%%%s", change, change > threshold ? " SLOWER" : "");
+			timing = text;
+			if (change > threshold)
+				slower++;
+		}
+
+		std::snprintf(line, sizeof(line), "%-24s %8.2f ns/instruction %-18s %s%s", test.name.c_str(), result.nsPerInstruction, timing.c_str(),
+			status.c_str(), result.error != Chip8::None ? " (stopped on an error)" : "");
+		std::cout << line << std::endl;
+	}
+
+	std::cout << tests.size() << " ROMs on " << threads << " threads in " << seconds << "s, " << differing << " differ, "
+		<< slower << " slower than " << threshold << "% over golden" << std::endl;
+	return differing == 0 && slower == 0 ? 0 : 1;
+}
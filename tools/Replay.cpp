@@ -0,0 +1,94 @@
+/*
+
+CHP-8 Replay (chp8-replay)
+
+Plays an input log recorded by the emulator (--record) back against its ROM, headless and as fast as the host
+allows, and checks the framebuffer hash after every frame against the one recorded. Exits 0 if every frame matches
+and reports the first frame that doesn't otherwise, so a report from a user can be reproduced and stepped through
+exactly, and a corpus of logs doubles as a regression suite.
+
+Usage: chp8-replay <rom> <input log> [--engine interpreter|threaded|recompiled]
+
+The quirk profile comes from the log, see Quirks.hpp. Version 1 logs are rejected.
+
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../src/core/CHP-8.hpp"
+#include "../src/core/InputLog.hpp"
+#include "../src/core/Scheduler.hpp"
+
+using namespace chp8;
+
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		std::cout << "Usage: " << argv[0] << " <rom> <input log> [--engine interpreter|threaded|recompiled]" << std::endl;
+		return 1;
+	}
+
+	Chip8::Engine engine = Chip8::Threaded;
+	for (int a = 3; a < argc; a++) {
+		std::string arg = argv[a];
+		if (arg == "--engine" && a + 1 < argc) {
+			std::string name = argv[++a];
+			if (name == "interpreter")
+				engine = Chip8::Interpreter;
+			else if (name == "threaded")
+				engine = Chip8::Threaded;
+			else if (name == "recompiled")
+				engine = Chip8::Recompiled;
+			else {
+				std::cout << "Unknown engine " << name << std::endl;
+				return 1;
+			}
+		}
+		else {
+			std::cout << "Unknown option " << arg << std::endl;
+			return 1;
+		}
+	}
+
+	std::ifstream file(argv[1], std::ios::binary);
+	if (!file) {
+		std::cout << "Failed to read " << argv[1] << std::endl;
+		return 1;
+	}
+	std::vector<uint8_t> rom((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	InputLog log;
+	if (!log.load(argv[2]))
+		return 1;
+
+	Chip8 chip("chip8", "");
+	chip.setEngine(engine);
+	chip.loadProgram(rom.data(), rom.size());
+	Scheduler scheduler(chip);
+	scheduler.play(&log);
+
+	const std::vector<uint64_t>& expected = log.getFrameHashes();
+	auto start = std::chrono::steady_clock::now();
+	size_t frame = 0;
+	for (; frame < expected.size(); frame++) {
+		scheduler.runFrame();
+		if (chip.getFramebuffer().hash() != expected[frame])
+			break;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	if (frame < expected.size()) {
+		std::cout << "Frame " << frame << " differs from the recording (cycle " << scheduler.getCycleCount() << ", PC "
+			<< std::hex << chip.getPC() << std::dec << ")" << std::endl;
+		return 1;
+	}
+
+	std::cout << expected.size() << " frames, " << scheduler.getCycleCount() << " instructions matched in " << seconds << "s ("
+		<< (seconds > 0 ? expected.size() / seconds / Scheduler::FrameHz : 0) << "x real time)" << std::endl;
+	return 0;
+}
@@ -0,0 +1,284 @@
+/*
+
+CHP-8 Static Recompiler
+
+Translates a ROM into a C++ translation unit ahead of time. Every basic block reachable from the entry point becomes
+a case of a switch on the PC, built from the same Operations.hpp functions the interpreter uses, so an -O3 build of
+the output runs known ROMs with no fetch, decode or dispatch. Indirect jumps, code written at runtime and anything
+the walk didn't discover go back through the interpreter trampoline.
+
+Usage: StaticRecompiler <rom> <output.cpp> [function name] [quirk profile]
+
+The output defines "int <function name>(chp8::CompiledContext& context, int count)". Build it with src/core/ on the
+include path, link it into the emulator and pass it to Chip8::setCompiledProgram() with the Compiled engine. The
+quirk profile (chip8, schip or xochip, see Quirks.hpp) is compiled in, so it has to match the Chip8's.
+
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/core/Instruction.hpp"
+#include "../src/core/Quirks.hpp"
+#include "../src/core/Recompiler.hpp"
+
+using namespace chp8;
+
+/****************************************************************
+			Discovery
+****************************************************************/
+
+static const uint32_t LoadAddress = 0x200;
+static const uint32_t MemorySize = 0x1000;
+
+struct Block {
+	uint16_t start;
+	std::vector<Instruction> instructions; // Compiled body, the last one may be a terminator
+};
+
+static uint8_t image[MemorySize];
+
+static Instruction instructionAt(uint32_t address) {
+	return decode((image[address] << 8) | image[address + 1]);
+}
+
+static std::string hex(uint32_t value, int digits) {
+	char text[16];
+	std::snprintf(text, sizeof(text), "0x%0*X", digits, value);
+	return text;
+}
+
+/*
+Walks the control flow from the entry point. The CHIP-8 has no distinction between code and data, so this only
+follows what it can see statically; BNNN targets and returns are left to the trampoline
+*/
+static std::map<uint16_t, Block> discoverBlocks() {
+	std::map<uint16_t, Block> blocks;
+	std::set<uint32_t> visited;
+	std::vector<uint32_t> work{ LoadAddress };
+
+	auto follow = [&](uint32_t address) {
+		if ((address & 1) == 0 && address + 1 < MemorySize && !visited.count(address))
+			work.push_back(address);
+	};
+
+	while (!work.empty()) {
+		uint32_t start = work.back();
+		work.pop_back();
+		if (!visited.insert(start).second)
+			continue;
+
+		Block block;
+		block.start = (uint16_t)start;
+		uint32_t address = start;
+		bool terminated = false;
+		for (; address + 1 < MemorySize; address += 2) {
+			Instruction in = instructionAt(address);
+			if (!Recompiler::canCompile(in.op))
+				break;
+			block.instructions.push_back(in);
+			if (Recompiler::endsBlock(in.op)) {
+				terminated = true;
+				break;
+			}
+		}
+
+		if (!block.instructions.empty())
+			blocks[block.start] = block;
+
+		if (terminated) {
+			const Instruction& last = block.instructions.back();
+			if (last.op == Op1NNN) {
+				follow(last.nnn);
+			}
+			else {
+				follow(address + 2);
+				follow(address + 4);
+			}
+			continue;
+		}
+
+		// The block stopped at an instruction the interpreter will run, carry on to wherever that goes
+		if (address + 1 >= MemorySize)
+			continue;
+		Instruction stop = instructionAt(address);
+		switch (stop.op) {
+		case Op2NNN:
+			follow(stop.nnn);
+			follow(address + 2); // Where it returns to
+			break;
+
+		case OpEX9E:
+		case OpEXA1:
+			follow(address + 2);
+			follow(address + 4);
+			break;
+
+		case Op00EE:
+		case OpBNNN:
+		case OpUnknown:
+			break;
+
+		default:
+			follow(address + 2);
+			break;
+		}
+	}
+
+	return blocks;
+}
+
+/****************************************************************
+			Emission
+****************************************************************/
+
+static const char* policyName(QuirkProfile profile) {
+	switch (profile) {
+	case SuperChip: return "SuperChipQuirks";
+	case XoChip: return "XoChipQuirks";
+	default: return "CosmacQuirks";
+	}
+}
+
+static std::string emitStatement(const Instruction& in, uint16_t address, QuirkProfile profile) {
+	std::string x = hex(in.x, 1), y = hex(in.y, 1), kk = hex(in.kk, 2);
+	std::string q = std::string("<") + policyName(profile) + ">";
+	std::string next = hex((uint16_t)(address + 2), 3), skip = hex((uint16_t)(address + 4), 3);
+
+	switch (in.op) {
+	case Op1NNN: return "pc = " + hex(in.nnn, 3) + ";";
+	case Op3XKK: return "pc = ops::skip3XKK(v, " + x + ", " + kk + ") ? " + skip + " : " + next + ";";
+	case Op4XKK: return "pc = ops::skip4XKK(v, " + x + ", " + kk + ") ? " + skip + " : " + next + ";";
+	case Op5XY0: return "pc = ops::skip5XY0(v, " + x + ", " + y + ") ? " + skip + " : " + next + ";";
+	case Op9XY0: return "pc = ops::skip9XY0(v, " + x + ", " + y + ") ? " + skip + " : " + next + ";";
+	case Op6XKK: return "ops::execute6XKK(v, " + x + ", " + kk + ");";
+	case Op7XKK: return "ops::execute7XKK(v, " + x + ", " + kk + ");";
+	case Op8XY0: return "ops::execute8XY0(v, " + x + ", " + y + ");";
+	case Op8XY1: return "ops::execute8XY1" + q + "(v, " + x + ", " + y + ");";
+	case Op8XY2: return "ops::execute8XY2" + q + "(v, " + x + ", " + y + ");";
+	case Op8XY3: return "ops::execute8XY3" + q + "(v, " + x + ", " + y + ");";
+	case Op8XY4: return "ops::execute8XY4(v, " + x + ", " + y + ");";
+	case Op8XY5: return "ops::execute8XY5(v, " + x + ", " + y + ");";
+	case Op8XY6: return "ops::execute8XY6" + q + "(v, " + x + ", " + y + ");";
+	case Op8XY7: return "ops::execute8XY7(v, " + x + ", " + y + ");";
+	case Op8XYE: return "ops::execute8XYE" + q + "(v, " + x + ", " + y + ");";
+	case OpANNN: return "ops::executeANNN(i, " + hex(in.nnn, 3) + ");";
+	default: return "// Not compilable";
+	}
+}
+
+static void emitBlock(std::ostream& out, const Block& block, QuirkProfile profile) {
+	size_t length = block.instructions.size();
+	uint16_t end = (uint16_t)(block.start + length * 2);
+
+	out << "\t\tcase " << hex(block.start, 3) << ": // " << hex(block.start, 3) << " - " << hex(end - 1, 3) << "\n";
+
+	// Drop back to the interpreter if the block doesn't fit in this run, or any of its code has been rewritten
+	out << "\t\t\tif (remaining < " << length;
+	for (uint16_t address = block.start; address < end; address += 2) {
+		out << " || modified[" << hex(address >> 1, 3) << "]";
+	}
+	out << ")\n\t\t\t\tbreak;\n";
+
+	uint16_t address = block.start;
+	for (const Instruction& in : block.instructions) {
+		out << "\t\t\t" << emitStatement(in, address, profile) << " // " << hex(in.opcode, 4) << "\n";
+		address += 2;
+	}
+
+	out << "\t\t\tremaining -= " << length << ";\n";
+	if (!Recompiler::endsBlock(block.instructions.back().op))
+		out << "\t\t\tpc = " << hex(end, 3) << ";\n";
+	out << "\t\t\tcontinue;\n\n";
+}
+
+static void emitProgram(std::ostream& out, const std::map<uint16_t, Block>& blocks, const std::string& romPath, const std::string& name,
+	const std::string& profileName, QuirkProfile profile) {
+	out << "/*\n\nGenerated by the CHP-8 static recompiler from " << romPath << " for the " << profileName << " quirk profile, do not edit.\n\n*/\n\n";
+	out << "#include \"CompiledProgram.hpp\"\n";
+	out << "#include \"Operations.hpp\"\n";
+	out << "#include \"Quirks.hpp\"\n\n";
+	out << "int " << name << "(chp8::CompiledContext& context, int count) {\n";
+	out << "\tusing namespace chp8;\n\n";
+
+	// Only bind what the blocks use, so the output builds warning free with -Wall
+	bool usesV = false, usesI = false;
+	for (const auto& entry : blocks) {
+		for (const Instruction& in : entry.second.instructions) {
+			usesI = usesI || in.op == OpANNN;
+			usesV = usesV || (in.op != OpANNN && in.op != Op1NNN);
+		}
+	}
+	if (usesV)
+		out << "\tuint8_t* v = context.v;\n";
+	if (usesI)
+		out << "\tuint16_t& i = *context.i;\n";
+	out << "\tuint16_t& pc = *context.pc;\n";
+	if (!blocks.empty())
+		out << "\tconst uint8_t* modified = context.modified;\n";
+	out << "\n";
+	out << "\tint remaining = count;\n";
+	out << "\twhile (remaining > 0) {\n";
+	out << "\t\tswitch (pc) {\n";
+	for (const auto& entry : blocks) {
+		emitBlock(out, entry.second, profile);
+	}
+	out << "\t\tdefault:\n\t\t\tbreak;\n\t\t}\n\n";
+	out << "\t\t// No usable block here, interpret a single instruction\n";
+	out << "\t\tremaining -= interpretInstruction(*context.chip);\n";
+	out << "\t}\n";
+	out << "\treturn count;\n";
+	out << "}\n";
+}
+
+/****************************************************************
+			Main
+****************************************************************/
+
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		std::cout << "Usage: " << argv[0] << " <rom> <output.cpp> [function name] [quirk profile]" << std::endl;
+		return 1;
+	}
+	std::string romPath = argv[1];
+	std::string outputPath = argv[2];
+	std::string name = argc > 3 ? argv[3] : "chp8_compiled_program";
+	std::string profileName = argc > 4 ? argv[4] : "chip8";
+
+	QuirkProfile profile;
+	if (!findQuirkProfile(profileName, profile)) {
+		std::cout << "Unknown quirk profile " << profileName << ", expected chip8, schip or xochip" << std::endl;
+		return 1;
+	}
+
+	std::ifstream rom(romPath, std::ios::binary);
+	if (!rom) {
+		std::cout << "Failed to open ROM " << romPath << std::endl;
+		return 1;
+	}
+	rom.read((char*)image + LoadAddress, MemorySize - LoadAddress);
+	std::streamsize romSize = rom.gcount();
+
+	std::map<uint16_t, Block> blocks = discoverBlocks();
+
+	std::ofstream output(outputPath);
+	if (!output) {
+		std::cout << "Failed to open " << outputPath << " for writing" << std::endl;
+		return 1;
+	}
+	emitProgram(output, blocks, romPath, name, profileName, profile);
+
+	size_t compiled = 0;
+	for (const auto& entry : blocks) {
+		compiled += entry.second.instructions.size();
+	}
+	std::cout << romSize << " byte ROM, " << blocks.size() << " blocks, " << compiled << " instructions compiled to " << outputPath << std::endl;
+	return 0;
+}
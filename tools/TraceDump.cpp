@@ -0,0 +1,71 @@
+/*
+
+CHP-8 Trace Dump
+
+Renders a binary trace written by chp8::Tracer as text, one instruction per line:
+
+	<index>  <pc>  <opcode>  <pattern>  I=<i>  <changed registers>
+
+Usage: TraceDump <trace file> [first record] [record count]
+
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "../src/core/Instruction.hpp"
+#include "../src/core/Tracer.hpp"
+
+using namespace chp8;
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::cout << "Usage: " << argv[0] << " <trace file> [first record] [record count]" << std::endl;
+		return 1;
+	}
+	uint64_t first = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 0;
+	uint64_t count = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : UINT64_MAX;
+
+	std::ifstream file(argv[1], std::ios::binary);
+	if (!file) {
+		std::cout << "Failed to open " << argv[1] << std::endl;
+		return 1;
+	}
+
+	Tracer::FileHeader header;
+	if (!file.read((char*)&header, sizeof(header)) || std::memcmp(header.magic, Tracer::Magic, sizeof(header.magic)) != 0) {
+		std::cout << argv[1] << " is not a CHP-8 trace" << std::endl;
+		return 1;
+	}
+	if (header.version != Tracer::Version || header.recordSize != sizeof(Tracer::Record)) {
+		std::cout << "Unsupported trace version " << header.version << " (record size " << header.recordSize << ")" << std::endl;
+		return 1;
+	}
+
+	file.seekg(sizeof(header) + first * sizeof(Tracer::Record));
+
+	Tracer::Record record;
+	char line[160];
+	for (uint64_t index = first; count > 0 && file.read((char*)&record, sizeof(record)); index++, count--) {
+		Instruction in = decode(record.opcode);
+		int length = std::snprintf(line, sizeof(line), "%10llu  %03X  %04X  %s  I=%03X ",
+			(unsigned long long)index, record.pc, record.opcode, operationName(in.op), record.i);
+
+		int stored = 0;
+		for (int i = 0; i < 0x10 && length < (int)sizeof(line); i++) {
+			if ((record.changed & (1 << i)) == 0)
+				continue;
+			if (stored < 8)
+				length += std::snprintf(line + length, sizeof(line) - length, " V%X=%02X", i, record.values[stored++]);
+			else
+				length += std::snprintf(line + length, sizeof(line) - length, " V%X=??", i);
+		}
+
+		std::cout << line << '\n';
+	}
+	return 0;
+}